@@ -0,0 +1,74 @@
+#!/bin/sh
+# Scaling benchmark: generates instances with ./generator, runs ./a.out on them and
+# appends one CSV line per run to $BENCH_CSV (bench.csv by default).
+# Sweeps are set by the environment, for example: DAYS="30 90" OBJECTS="50 200" ./bench.sh
+
+SCHEDULER=${SCHEDULER:-./a.out}
+GENERATOR=${GENERATOR:-./generator}
+BENCH_CSV=${BENCH_CSV:-bench.csv}
+BENCH_DIR=${BENCH_DIR:-bench_data}
+TIME_LIMIT=${TIME_LIMIT:-60}
+WORKERS=${WORKERS:-0}
+SEEDS=${SEEDS:-"1"}
+PATTERNS=${PATTERNS:-"orbital tight infeasible"}
+DAYS=${DAYS:-"12 30 90"}
+SLOTS=${SLOTS:-"10 30"}
+OBJECTS=${OBJECTS:-"10 50 100"}
+WINDOWS=${WINDOWS:-"7"}
+RATIOS=${RATIOS:-"2"}
+DENSITY=${DENSITY:-0.3}
+A_DAYS=${A_DAYS:-2}
+A_VIEWS=${A_VIEWS:-1}
+B_DAYS=${B_DAYS:-3}
+B_VIEWS=${B_VIEWS:-2}
+EXTRA_FLAGS=${EXTRA_FLAGS:-""}
+
+# Value of a top-level number or string field of the --stats-json report
+json_field() {
+    sed -n "s/^  \"$1\": \"\{0,1\}\([^\",]*\)\"\{0,1\},\{0,1\}$/\1/p" "$2" | head -n 1
+}
+
+json_model_field() {
+    sed -n "s/^  \"model\": .*\"$1\": \([0-9]*\).*/\1/p" "$2" | head -n 1
+}
+
+mkdir -p "$BENCH_DIR"
+if [ ! -f "$BENCH_CSV" ]; then
+    echo "pattern,seed,days,slots,objects,window,ratio,status,build_seconds,solve_seconds,total_seconds,peak_rss_kb,variables,constraints,terms" > "$BENCH_CSV"
+fi
+
+for pattern in $PATTERNS; do
+for seed in $SEEDS; do
+for days in $DAYS; do
+for slots in $SLOTS; do
+for objects in $OBJECTS; do
+for window in $WINDOWS; do
+for ratio in $RATIOS; do
+    name="$pattern-s$seed-d$days-l$slots-o$objects-w$window-r$ratio"
+    matrix="$BENCH_DIR/$name.txt"
+    types="$BENCH_DIR/$name.types"
+    stats="$BENCH_DIR/$name.json"
+    "$GENERATOR" --pattern "$pattern" --seed "$seed" --density "$DENSITY" \
+        --days "$days" --slots "$slots" --objects "$objects" --window "$window" \
+        --a_days "$A_DAYS" --a_views "$A_VIEWS" --b_days "$B_DAYS" --b_views "$B_VIEWS" \
+        --ratio "$ratio" --matrix "$matrix" --types "$types" 2> /dev/null || continue
+    rm -f "$stats"
+    # shellcheck disable=SC2086
+    "$SCHEDULER" --days "$days" --slots "$slots" --objects "$objects" --window "$window" \
+        --a_days "$A_DAYS" --a_views "$A_VIEWS" --b_days "$B_DAYS" --b_views "$B_VIEWS" \
+        --ratio "$ratio" --matrix "$matrix" --types "$types" \
+        --time_limit "$TIME_LIMIT" --workers "$WORKERS" --stats-json "$stats" $EXTRA_FLAGS \
+        > /dev/null 2>&1
+    if [ ! -f "$stats" ]; then
+        echo "$pattern,$seed,$days,$slots,$objects,$window,$ratio,ERROR,,,,,,," >> "$BENCH_CSV"
+        continue
+    fi
+    echo "$pattern,$seed,$days,$slots,$objects,$window,$ratio,$(json_field status "$stats"),$(json_field build_seconds "$stats"),$(json_field solve_seconds "$stats"),$(json_field total_seconds "$stats"),$(json_field peak_rss_kb "$stats"),$(json_model_field variables "$stats"),$(json_model_field constraints "$stats"),$(json_model_field terms "$stats")" >> "$BENCH_CSV"
+    echo "$name: $(json_field status "$stats")"
+done
+done
+done
+done
+done
+done
+done
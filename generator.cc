@@ -0,0 +1,357 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <algorithm>
+
+// Synthetic instance generator: writes an availability matrix and an objects type
+// vector in the formats main.cc reads. The same flags and seed give the same files
+
+const std::string DAYS_KEY = "--days";
+const std::string SLOTS_KEY = "--slots";
+const std::string OBJECTS_KEY = "--objects";
+const std::string WINDOW_KEY = "--window";
+const std::string A_DAYS_KEY = "--a_days";
+const std::string B_DAYS_KEY = "--b_days";
+const std::string A_VIEWS_KEY = "--a_views";
+const std::string B_VIEWS_KEY = "--b_views";
+const std::string RATIO_KEY = "--ratio";
+const std::string MATRIX_KEY = "--matrix";
+const std::string TYPES_KEY = "--types";
+const std::string SEED_KEY = "--seed";
+const std::string DENSITY_KEY = "--density";
+const std::string TYPE_A_SHARE_KEY = "--type_a_share";
+const std::string PATTERN_KEY = "--pattern";
+
+// random: every cell is available with probability density
+// orbital: every object is visible in a drifting run of slots during its observation season
+// tight: a planted feasible schedule plus random cells with probability density
+// infeasible: all objects are visible only in the first days, which can't fit all views
+const std::string RANDOM_PATTERN = "random";
+const std::string ORBITAL_PATTERN = "orbital";
+const std::string TIGHT_PATTERN = "tight";
+const std::string INFEASIBLE_PATTERN = "infeasible";
+
+int num_days = 12;
+int num_daily_slots = 10;
+int num_objects = 10;
+int daily_slots_window_size = 7;
+int days_requirement_type_a = 2;
+int days_requirement_type_b = 3;
+int daily_views_requirement_type_a = 1;
+int daily_views_requirement_type_b = 2;
+int progression_ratio = 2;
+std::string availability_matrix_filename = "data/generated_limits.txt";
+std::string objects_type_filename = "data/generated_objtype.txt";
+uint64_t seed = 1;
+double density = 0.5;
+double type_a_share = 0.5;
+std::string pattern = ORBITAL_PATTERN;
+
+int num_total_slots = num_days * num_daily_slots;
+
+void
+generate_random(std::mt19937_64& generator, std::vector<uint8_t>& availability_matrix)
+{
+    std::bernoulli_distribution is_available(density);
+    for (size_t cell_index = 0; cell_index < availability_matrix.size(); cell_index++) {
+        availability_matrix[cell_index] = is_available(generator);
+    }
+}
+
+void
+generate_orbital(std::mt19937_64& generator, std::vector<uint8_t>& availability_matrix)
+{
+    // density is the share of the day slots in the visibility run
+    int run_length = std::max(1, int(density * num_daily_slots + 0.5));
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        double first_slot = unit(generator) * num_daily_slots;
+        // Visibility shifts by a fraction of a slot every day
+        double daily_drift = (unit(generator) - 0.5) * 0.5;
+        int season_length = std::max(1, int(num_days * (0.5 + 0.5 * unit(generator))));
+        int season_start = int(unit(generator) * num_days);
+        for (int day_index = 0; day_index < num_days; day_index++) {
+            if ((day_index - season_start + num_days) % num_days >= season_length) {
+                continue;
+            }
+            int run_start = int(first_slot + daily_drift * day_index);
+            for (int shift = 0; shift < run_length; shift++) {
+                int slot_index = ((run_start + shift) % num_daily_slots + num_daily_slots) %
+                                 num_daily_slots;
+                int global_slot_index = day_index * num_daily_slots + slot_index;
+                availability_matrix[global_slot_index * num_objects + object_index] = 1;
+            }
+        }
+    }
+}
+
+// Places views of one object in a day into free slots of the day keeping all
+// used slots of the day inside daily_slots_window_size consecutive slots
+bool
+plant_day_views(std::mt19937_64& generator,
+                int day_index,
+                int object_index,
+                int daily_views,
+                std::vector<uint8_t>& is_slot_used,
+                std::vector<uint8_t>& availability_matrix)
+{
+    int first_used_slot = num_daily_slots;
+    int last_used_slot = -1;
+    for (int slot_index = 0; slot_index < num_daily_slots; slot_index++) {
+        if (is_slot_used[day_index * num_daily_slots + slot_index]) {
+            first_used_slot = std::min(first_used_slot, slot_index);
+            last_used_slot = std::max(last_used_slot, slot_index);
+        }
+    }
+    int window_size = std::min(daily_slots_window_size, num_daily_slots);
+    int lowest_slot = 0;
+    int highest_slot = num_daily_slots - 1;
+    if (last_used_slot >= 0) {
+        lowest_slot = std::max(0, last_used_slot - window_size + 1);
+        highest_slot = std::min(num_daily_slots - 1, first_used_slot + window_size - 1);
+    }
+    std::vector<int> free_slots;
+    for (int slot_index = lowest_slot; slot_index <= highest_slot; slot_index++) {
+        if (not is_slot_used[day_index * num_daily_slots + slot_index]) {
+            free_slots.push_back(slot_index);
+        }
+    }
+    if (int(free_slots.size()) < daily_views) {
+        return false;
+    }
+    // Take a run of consecutive free slots starting at a random one, so the
+    // day window isn't widened more than needed
+    std::uniform_int_distribution<int> first_free(0, free_slots.size() - daily_views);
+    int first_index = first_free(generator);
+    for (int view_index = 0; view_index < daily_views; view_index++) {
+        int global_slot_index = day_index * num_daily_slots + free_slots[first_index + view_index];
+        is_slot_used[global_slot_index] = 1;
+        availability_matrix[global_slot_index * num_objects + object_index] = 1;
+    }
+    return true;
+}
+
+void
+generate_tight(std::mt19937_64& generator,
+               const std::vector<uint8_t>& objects_type,
+               std::vector<uint8_t>& availability_matrix)
+{
+    std::vector<int> day_shifts(1, 0);
+    int current_progression_element = 1;
+    for (int progression_index = 0; progression_index < days_requirement_type_b - 1;
+         progression_index++) {
+        day_shifts.push_back(day_shifts.back() + current_progression_element);
+        current_progression_element *= std::max(1, progression_ratio);
+    }
+
+    std::vector<uint8_t> is_slot_used(num_total_slots, 0);
+    std::vector<int> days(num_days);
+    int num_planted = 0;
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        std::vector<int> chosen_days;
+        int daily_views;
+        if (objects_type[object_index]) {
+            daily_views = daily_views_requirement_type_a;
+            for (int day_index = 0; day_index < num_days; day_index++) {
+                days[day_index] = day_index;
+            }
+            std::shuffle(days.begin(), days.end(), generator);
+            chosen_days.assign(days.begin(),
+                               days.begin() + std::min(num_days, days_requirement_type_a));
+        } else {
+            daily_views = daily_views_requirement_type_b;
+            if (day_shifts.back() >= num_days) {
+                continue;
+            }
+            std::uniform_int_distribution<int> start_day(0, num_days - 1 - day_shifts.back());
+            int first_day = start_day(generator);
+            for (int day_shift : day_shifts) {
+                chosen_days.push_back(first_day + day_shift);
+            }
+        }
+        bool is_planted = true;
+        for (int day_index : chosen_days) {
+            is_planted = is_planted and plant_day_views(generator, day_index, object_index,
+                                                        daily_views, is_slot_used,
+                                                        availability_matrix);
+        }
+        num_planted += is_planted;
+    }
+    std::cerr << "Planted schedule covers " << num_planted << " of " << num_objects
+              << " objects" << std::endl;
+
+    // Noise cells the planted schedule doesn't use
+    std::bernoulli_distribution is_available(density);
+    for (size_t cell_index = 0; cell_index < availability_matrix.size(); cell_index++) {
+        if (is_available(generator)) {
+            availability_matrix[cell_index] = 1;
+        }
+    }
+}
+
+void
+generate_infeasible(const std::vector<uint8_t>& objects_type,
+                    std::vector<uint8_t>& availability_matrix)
+{
+    // Views needed per day if every object is squeezed into the active days
+    int64_t total_views = 0;
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        total_views += objects_type[object_index]
+                         ? int64_t(days_requirement_type_a) * daily_views_requirement_type_a
+                         : int64_t(days_requirement_type_b) * daily_views_requirement_type_b;
+    }
+    int daily_capacity = std::min(daily_slots_window_size, num_daily_slots);
+    int max_day_shift = 0;
+    int current_progression_element = 1;
+    for (int progression_index = 0; progression_index < days_requirement_type_b - 1;
+         progression_index++) {
+        max_day_shift += current_progression_element;
+        current_progression_element *= std::max(1, progression_ratio);
+    }
+    // Enough days for every single object, but not enough slots for all of them
+    int active_days = std::max({days_requirement_type_a, max_day_shift + 1, 1});
+    if (int64_t(active_days) * daily_capacity >= total_views) {
+        std::cerr << "Warning: " << num_objects << " objects need only " << total_views
+                  << " views, the instance may be feasible, add objects" << std::endl;
+    }
+    active_days = std::min(active_days, num_days);
+    for (int slot_index = 0; slot_index < active_days * num_daily_slots; slot_index++) {
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            availability_matrix[slot_index * num_objects + object_index] = 1;
+        }
+    }
+}
+
+bool
+save_files(const std::vector<uint8_t>& availability_matrix, const std::vector<uint8_t>& objects_type)
+{
+    std::ofstream matrix_file(availability_matrix_filename, std::ios::trunc);
+    if (not matrix_file.is_open()) {
+        std::cerr << "Can't open file " << availability_matrix_filename << std::endl;
+        return false;
+    }
+    std::string line;
+    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+        line.clear();
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            if (object_index > 0) {
+                line += ',';
+            }
+            line += availability_matrix[slot_index * num_objects + object_index] ? '1' : '0';
+        }
+        line += '\n';
+        matrix_file << line;
+    }
+
+    std::ofstream types_file(objects_type_filename, std::ios::trunc);
+    if (not types_file.is_open()) {
+        std::cerr << "Can't open file " << objects_type_filename << std::endl;
+        return false;
+    }
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        types_file << (objects_type[object_index] ? '1' : '0') << '\n';
+    }
+    return matrix_file.good() and types_file.good();
+}
+
+int
+main(int argc, char* argv[])
+{
+    int i = 1;
+    while (i < argc){
+        try {
+            std::string cur_key(argv[i]);
+            if (cur_key == "--help") {
+                break;
+            }
+            if (++i >= argc) {
+                std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                return 1;
+            }
+            if (cur_key == DAYS_KEY) {
+                num_days = std::stoi(argv[i]);
+            } else if (cur_key == SLOTS_KEY) {
+                num_daily_slots = std::stoi(argv[i]);
+            } else if (cur_key == OBJECTS_KEY) {
+                num_objects = std::stoi(argv[i]);
+            } else if (cur_key == WINDOW_KEY) {
+                daily_slots_window_size = std::stoi(argv[i]);
+            } else if (cur_key == A_DAYS_KEY) {
+                days_requirement_type_a = std::stoi(argv[i]);
+            } else if (cur_key == B_DAYS_KEY) {
+                days_requirement_type_b = std::stoi(argv[i]);
+            } else if (cur_key == A_VIEWS_KEY) {
+                daily_views_requirement_type_a = std::stoi(argv[i]);
+            } else if (cur_key == B_VIEWS_KEY) {
+                daily_views_requirement_type_b = std::stoi(argv[i]);
+            } else if (cur_key == RATIO_KEY) {
+                progression_ratio = std::stoi(argv[i]);
+            } else if (cur_key == MATRIX_KEY) {
+                availability_matrix_filename = argv[i];
+            } else if (cur_key == TYPES_KEY) {
+                objects_type_filename = argv[i];
+            } else if (cur_key == SEED_KEY) {
+                seed = std::stoull(argv[i]);
+            } else if (cur_key == DENSITY_KEY) {
+                density = std::stod(argv[i]);
+            } else if (cur_key == TYPE_A_SHARE_KEY) {
+                type_a_share = std::stod(argv[i]);
+            } else if (cur_key == PATTERN_KEY) {
+                pattern = argv[i];
+            } else {
+                std::cerr << "Unknown option '" << cur_key << "'" << std::endl;
+                return 1;
+            }
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Invalid argument, after flag: " << argv[i-1] << " expected number, but found: " << argv[i] << std::endl;
+            return 1;
+        } catch (const std::out_of_range& e) {
+            std::cerr << "Argument out of range: " << argv[i] << std::endl;
+            return 1;
+        }
+        i++;
+    }
+    if (i < argc) {
+        std::cerr << "Use " << DAYS_KEY << ", " << SLOTS_KEY << ", " << OBJECTS_KEY << ", "
+                  << WINDOW_KEY << ", " << A_DAYS_KEY << ", " << B_DAYS_KEY << ", "
+                  << A_VIEWS_KEY << ", " << B_VIEWS_KEY << ", " << RATIO_KEY << ", "
+                  << MATRIX_KEY << ", " << TYPES_KEY << ", " << SEED_KEY << ", "
+                  << DENSITY_KEY << ", " << TYPE_A_SHARE_KEY << ", " << PATTERN_KEY << " ("
+                  << RANDOM_PATTERN << ", " << ORBITAL_PATTERN << ", " << TIGHT_PATTERN << ", "
+                  << INFEASIBLE_PATTERN << ")" << std::endl;
+        return 0;
+    }
+    num_total_slots = num_days * num_daily_slots;
+
+    std::mt19937_64 generator(seed);
+    std::vector<uint8_t> objects_type(num_objects);
+    std::bernoulli_distribution is_type_a(type_a_share);
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        objects_type[object_index] = is_type_a(generator);
+    }
+
+    std::vector<uint8_t> availability_matrix(size_t(num_total_slots) * num_objects, 0);
+    if (pattern == RANDOM_PATTERN) {
+        generate_random(generator, availability_matrix);
+    } else if (pattern == ORBITAL_PATTERN) {
+        generate_orbital(generator, availability_matrix);
+    } else if (pattern == TIGHT_PATTERN) {
+        generate_tight(generator, objects_type, availability_matrix);
+    } else if (pattern == INFEASIBLE_PATTERN) {
+        generate_infeasible(objects_type, availability_matrix);
+    } else {
+        std::cerr << "Unknown pattern '" << pattern << "'" << std::endl;
+        return 1;
+    }
+
+    if (not save_files(availability_matrix, objects_type)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -2,18 +2,41 @@
 #include <stdlib.h>
 #include <vector>
 
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "ortools/base/logging.h"
 #include "ortools/sat/cp_model.h"
 #include "ortools/sat/cp_model.pb.h"
 #include "ortools/sat/cp_model_solver.h"
+#include "ortools/sat/sat_parameters.pb.h"
 #include "ortools/util/sorted_interval_list.h"
 
 #include "absl/types/span.h"
+#include "google/protobuf/text_format.h"
 
 const std::string DAYS_KEY = "--days";
 const std::string SLOTS_KEY = "--slots";
@@ -25,6 +48,50 @@ const std::string B_VIEWS_KEY = "--b_views";
 const std::string MATRIX_KEY = "--matrix";
 const std::string TYPES_KEY = "--types";
 const std::string RATIO_KEY = "--ratio";
+const std::string WINDOW_KEY = "--window";
+const std::string WINDOW_ENCODING_KEY = "--window_encoding";
+const std::string PROGRESSION_ENCODING_KEY = "--progression_encoding";
+const std::string OUTPUT_FORMAT_KEY = "--output_format";
+const std::string STREAM_KEY = "--stream";
+const std::string GRID_KEY = "--grid";
+const std::string BEST_EFFORT_KEY = "--best_effort";
+const std::string WEIGHTS_KEY = "--weights";
+const std::string DIAGNOSE_KEY = "--diagnose";
+const std::string DIAGNOSE_DAYS_KEY = "--diagnose_days";
+const std::string CORE_KEY = "--core";
+const std::string ENGINE_KEY = "--engine";
+const std::string HEURISTIC_ROUNDS_KEY = "--heuristic_rounds";
+const std::string MODEL_CACHE_KEY = "--model_cache";
+const std::string FIRST_DAY_KEY = "--first_day";
+const std::string LAST_DAY_KEY = "--last_day";
+const std::string BLOCK_KEY = "--block";
+const std::string SOCKET_KEY = "--socket";
+const std::string SERVE_WORKERS_KEY = "--serve_workers";
+const std::string SERVE_DIR_KEY = "--serve_dir";
+const std::string SERVE_QUIT_KEY = "--serve_quit";
+const std::string WORKERS_KEY = "--workers";
+const std::string TIME_LIMIT_KEY = "--time_limit";
+const std::string SEED_KEY = "--seed";
+const std::string DETERMINISTIC_KEY = "--deterministic";
+const std::string SAT_PARAMS_KEY = "--sat_params";
+const std::string OUTPUT_KEY = "--output";
+const std::string NO_PRESOLVE_KEY = "--no_presolve";
+const std::string NO_PRECHECK_KEY = "--no_precheck";
+const std::string STATS_JSON_KEY = "--stats-json";
+const std::string SCHEDULE_KEY = "--schedule";
+const std::string HINT_KEY = "--hint";
+const std::string HINT_MODE_KEY = "--hint_mode";
+const std::string ROLLING_WINDOW_KEY = "--rolling_window";
+const std::string ROLLING_OVERLAP_KEY = "--rolling_overlap";
+const std::string COMPARE_MONOLITHIC_KEY = "--compare_monolithic";
+const std::string BUILD_THREADS_KEY = "--build_threads";
+const std::string NO_DECOMPOSITION_KEY = "--no_decomposition";
+const std::string COMPONENT_THREADS_KEY = "--component_threads";
+const std::string NO_SYMMETRY_BREAKING_KEY = "--no_symmetry_breaking";
+
+const std::string CONVERT_COMMAND = "convert";
+const std::string VALIDATE_COMMAND = "validate";
+const std::string SERVE_COMMAND = "serve";
 
 const std::string DAYS_SHORT_KEY = "-d";
 const std::string SLOTS_SHORT_KEY = "-s";
@@ -33,6 +100,30 @@ const std::string MATRIX_SHORT_KEY = "-m";
 const std::string TYPES_SHORT_KEY = "-t";
 const std::string RATIO_SHORT_KEY = "-r";
 
+const std::string PAIRWISE_WINDOW_ENCODING = "pairwise";
+const std::string LINEAR_WINDOW_ENCODING = "linear";
+
+const std::string SPARSE_OUTPUT_FORMAT = "sparse";
+const std::string BINARY_OUTPUT_FORMAT = "binary";
+
+// prefix: w_{i} implies w_{i+shift} or an earlier viewed day
+// start: exactly one start day per object, the days follow from it
+const std::string PREFIX_PROGRESSION_ENCODING = "prefix";
+const std::string START_PROGRESSION_ENCODING = "start";
+
+// cp_sat: the solver only, heuristic: the greedy engine only,
+// hybrid: the greedy schedule is the solution hint of the solver
+const std::string CP_SAT_ENGINE = "cp_sat";
+const std::string HEURISTIC_ENGINE = "heuristic";
+const std::string HYBRID_ENGINE = "hybrid";
+
+// hint: the previous schedule is a solution hint only
+// repair: the solver repairs the hint locally first
+// fix: objects whose previous schedule is still valid are fixed to it
+const std::string HINT_MODE = "hint";
+const std::string REPAIR_HINT_MODE = "repair";
+const std::string FIX_HINT_MODE = "fix";
+
 int num_days = 6;
 int num_daily_slots = 10;
 int daily_slots_window_size = 7;
@@ -43,35 +134,398 @@ int daily_views_requirement_type_b = 2;
 int num_objects = 10;
 std::string availability_matrix_filename = "data/tiny_limits.txt";
 std::string objects_type_filename = "data/tiny_objtype.txt";
+std::string output_filename = "";
+std::string stats_json_filename = "";
+std::string schedule_filename = "";
+std::string hint_filename = "";
+std::string hint_mode = HINT_MODE;
+
+// Rolling horizon decomposition, 0 window days solves the whole horizon at once
+int rolling_window_days = 0;
+int rolling_overlap_days = 0;
+bool compare_monolithic = false;
+
+// Threads for model construction, the model is the same for any number of them
+int build_threads = std::max(1u, std::thread::hardware_concurrency());
+
+// Objects that never share a day are solved as separate models on component_threads threads
+bool use_decomposition = true;
+int component_threads = std::max(1u, std::thread::hardware_concurrency());
+
+// Lexicographic order of days between objects with the same type and availability
+bool use_symmetry_breaking = true;
 
 
 int num_total_slots = num_days * num_daily_slots;
 int progression_ratio = 2;
+std::string window_encoding = LINEAR_WINDOW_ENCODING;
+std::string progression_encoding = PREFIX_PROGRESSION_ENCODING;
 
-void
-load_matrix_from_file(const std::string& availability_matrix_filename,
-                      std::vector<bool>& availability_matrix)
+// sparse: "slot,object" lines, binary: bit matrix in the availability matrix format
+std::string output_format = SPARSE_OUTPUT_FORMAT;
+// Every schedule found during the search is written to output_filename
+bool stream_solutions = false;
+// The "# ." grid on the standard output
+bool print_grid = false;
+
+// Maximize the (weighted) number of fully scheduled objects instead of requiring all of them
+bool best_effort = false;
+std::string weights_filename;
+
+// Infeasibility diagnosis: objects, and with diagnose_days day windows, guarded by assumptions
+bool diagnose_mode = false;
+bool diagnose_days = false;
+std::string core_filename;
+
+std::string engine = CP_SAT_ENGINE;
+// Passes of the heuristic over the objects it couldn't place, blockers tried for every object
+int heuristic_repair_rounds = 8;
+int max_heuristic_blockers = 32;
+
+// Views are only allowed in the days [first_allowed_day, last_allowed_day], -1 is the last day,
+// and never in the blocked (first, last) slot ranges
+int first_allowed_day = 0;
+int last_allowed_day = -1;
+std::vector<std::pair<int, int>> blocked_slots;
+
+// serve mode: Unix socket path, standard input and output when empty, requests solved at once
+// and the directory of request files, a new temporary one when empty. Socket clients can stop
+// the server with quit only with serve_quit, standard input always can
+std::string socket_path;
+int serve_workers = 4;
+std::string serve_directory;
+bool serve_quit = false;
+
+// Directory of built models keyed by the hash of the inputs and the model parameters
+std::string model_cache_directory;
+bool use_presolve = true;
+// Necessary feasibility conditions checked before the model is built
+bool use_precheck = true;
+
+// Solver parameters, 0 workers means all available cores and 0 time limit means no limit
+int num_workers = 0;
+double time_limit_seconds = 0;
+int random_seed = -1;
+bool deterministic_search = false;
+std::string sat_parameters_text = "";
+
+// Private memory mapping of a whole file, writes go to copied pages and never to the file
+struct MappedFile
 {
-    std::ifstream file(availability_matrix_filename);
-    if (!file.is_open()) {
-        std::cerr << "Can't open file" << std::endl;
-        return;
+    char* data = nullptr;
+    size_t size = 0;
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename)
+    {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size = file_stat.st_size;
+        if (size > 0) {
+            void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                size = 0;
+                return false;
+            }
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            data = static_cast<char*>(mapping);
+        }
+        ::close(fd);
+        return true;
     }
-    std::string line;
+
+    ~MappedFile()
+    {
+        if (data != nullptr) {
+            munmap(data, size);
+        }
+    }
+};
+
+// Availability of objects in slots, one 64-bit word bitset per slot,
+// so a slot row is scanned by its set bits. Words are either owned or
+// point into a mapped binary matrix file
+struct AvailabilityMatrix
+{
+    int num_slots = 0;
+    int num_objects = 0;
+    int words_per_slot = 0;
+    uint64_t* words = nullptr;
+    std::vector<uint64_t> storage;
+    std::unique_ptr<MappedFile> mapping;
+
+    AvailabilityMatrix() = default;
+    AvailabilityMatrix(const AvailabilityMatrix&) = delete;
+    AvailabilityMatrix& operator=(const AvailabilityMatrix&) = delete;
+    AvailabilityMatrix(AvailabilityMatrix&&) = default;
+    AvailabilityMatrix& operator=(AvailabilityMatrix&&) = default;
+
+    void resize(int slots_count, int objects_count)
+    {
+        num_slots = slots_count;
+        num_objects = objects_count;
+        words_per_slot = (objects_count + 63) / 64;
+        mapping.reset();
+        storage.assign(size_t(num_slots) * words_per_slot, 0);
+        words = storage.data();
+    }
+
+    bool is_available(int slot_index, int object_index) const
+    {
+        return (words[size_t(slot_index) * words_per_slot + (object_index >> 6)] >>
+                (object_index & 63)) & 1;
+    }
+
+    void set_available(int slot_index, int object_index)
+    {
+        words[size_t(slot_index) * words_per_slot + (object_index >> 6)] |=
+          uint64_t(1) << (object_index & 63);
+    }
+
+    // Calls visit(object_index) for every object available in the slot, in increasing order
+    template <typename Visitor>
+    void for_each_available(int slot_index, Visitor visit) const
+    {
+        const uint64_t* slot_words = &words[size_t(slot_index) * words_per_slot];
+        for (int word_index = 0; word_index < words_per_slot; word_index++) {
+            uint64_t word = slot_words[word_index];
+            while (word != 0) {
+                visit(word_index * 64 + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+};
+
+// Binary availability matrix format, little-endian:
+// BinaryMatrixHeader, then days * slots rows of words_per_slot 64-bit words,
+// bit (object % 64) of word (object / 64) is set when the object is available
+const char BINARY_MATRIX_MAGIC[8] = {'S', 'A', 'T', 'A', 'V', 'A', 'I', 'L'};
+const uint32_t BINARY_MATRIX_VERSION = 1;
+
+struct BinaryMatrixHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t num_days;
+    uint32_t num_daily_slots;
+    uint32_t num_objects;
+    uint64_t reserved;
+};
+static_assert(sizeof(BinaryMatrixHeader) == 32, "Rows have to stay 8 bytes aligned");
+
+bool
+is_binary_matrix(const MappedFile& file)
+{
+    return (file.size >= sizeof(BINARY_MATRIX_MAGIC)) and
+           (std::equal(BINARY_MATRIX_MAGIC, BINARY_MATRIX_MAGIC + sizeof(BINARY_MATRIX_MAGIC),
+                       file.data));
+}
+
+// Uses the mapped words directly, only the header is read
+bool
+load_matrix_from_binary(const std::string& availability_matrix_filename,
+                        std::unique_ptr<MappedFile> file,
+                        AvailabilityMatrix& availability_matrix)
+{
+    if (file->size < sizeof(BinaryMatrixHeader)) {
+        std::cerr << availability_matrix_filename << ": truncated header" << std::endl;
+        return false;
+    }
+    BinaryMatrixHeader header;
+    std::copy(file->data, file->data + sizeof(header), reinterpret_cast<char*>(&header));
+    if (header.version != BINARY_MATRIX_VERSION) {
+        std::cerr << availability_matrix_filename << ": unsupported format version "
+                  << header.version << ", expected " << BINARY_MATRIX_VERSION << std::endl;
+        return false;
+    }
+    if ((int(header.num_daily_slots) != num_daily_slots) or
+        (int(header.num_objects) != num_objects) or (int(header.num_days) < num_days)) {
+        std::cerr << availability_matrix_filename << ": matrix is " << header.num_days
+                  << " days, " << header.num_daily_slots << " slots, " << header.num_objects
+                  << " objects, but --days " << num_days << " --slots " << num_daily_slots
+                  << " --objects " << num_objects << " are requested" << std::endl;
+        return false;
+    }
+    int words_per_slot = (num_objects + 63) / 64;
+    size_t rows_size = size_t(header.num_days) * header.num_daily_slots * words_per_slot *
+                       sizeof(uint64_t);
+    if (file->size != sizeof(header) + rows_size) {
+        std::cerr << availability_matrix_filename << ": expected " << sizeof(header) + rows_size
+                  << " bytes, found " << file->size << std::endl;
+        return false;
+    }
+    if (header.num_days > uint32_t(num_days)) {
+        std::cerr << availability_matrix_filename << ": days after " << num_days
+                  << " (--days) are ignored" << std::endl;
+    }
+
+    availability_matrix.num_slots = num_total_slots;
+    availability_matrix.num_objects = num_objects;
+    availability_matrix.words_per_slot = words_per_slot;
+    availability_matrix.storage.clear();
+    availability_matrix.words = reinterpret_cast<uint64_t*>(file->data + sizeof(header));
+    availability_matrix.mapping = std::move(file);
+    return true;
+}
+
+bool
+save_matrix_to_binary(const std::string& filename, const AvailabilityMatrix& availability_matrix)
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (not file.is_open()) {
+        std::cerr << "Can't open file " << filename << std::endl;
+        return false;
+    }
+    BinaryMatrixHeader header = {};
+    std::copy(BINARY_MATRIX_MAGIC, BINARY_MATRIX_MAGIC + sizeof(BINARY_MATRIX_MAGIC), header.magic);
+    header.version = BINARY_MATRIX_VERSION;
+    header.num_days = num_days;
+    header.num_daily_slots = num_daily_slots;
+    header.num_objects = availability_matrix.num_objects;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(availability_matrix.words),
+               size_t(availability_matrix.num_slots) * availability_matrix.words_per_slot *
+                 sizeof(uint64_t));
+    if (not file.good()) {
+        std::cerr << "Can't write file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Parses "0,1,..." lines, one line per slot and one column per object.
+// Every malformed cell or wrong row length is reported with its line and column
+bool
+load_matrix_from_csv(const std::string& availability_matrix_filename,
+                     const MappedFile& file,
+                     AvailabilityMatrix& availability_matrix)
+{
+    availability_matrix.resize(num_total_slots, num_objects);
+
+    const char* position = file.data;
+    const char* end = file.data + file.size;
+    const char* line_start = position;
+    int line_number = 1;
     int slot_index = 0;
+    int max_extra_columns = 0;
+
+    auto report = [&](const std::string& message) {
+        std::cerr << availability_matrix_filename << ":" << line_number << ":"
+                  << (position - line_start + 1) << ": " << message << std::endl;
+    };
 
-    while (std::getline(file, line) && slot_index < num_total_slots) {
-        std::stringstream ss(line);
-        std::string value;
+    while (position < end and slot_index < num_total_slots) {
         int object_index = 0;
-        while (std::getline(ss, value, ',') && object_index < num_objects) {
-            availability_matrix[slot_index * num_objects + object_index] =
-              (std::stoi(value) == 1);
+        bool line_is_over = false;
+        while (not line_is_over) {
+            while (position < end and (*position == ' ' or *position == '\t')) {
+                position++;
+            }
+            if (position == end or *position == '\n' or *position == '\r' or *position == ',') {
+                report("expected 0 or 1, found empty cell");
+                return false;
+            }
+            char cell = *position;
+            if (cell != '0' and cell != '1') {
+                report(std::string("expected 0 or 1, found '") + cell + "'");
+                return false;
+            }
+            position++;
+            while (position < end and (*position == ' ' or *position == '\t')) {
+                position++;
+            }
+            if (position < end and *position != ',' and *position != '\n' and *position != '\r') {
+                report(std::string("expected 0 or 1, found '") + cell + *position + "...'");
+                return false;
+            }
+            if (object_index < num_objects and cell == '1') {
+                availability_matrix.set_available(slot_index, object_index);
+            }
             object_index++;
+            if (position < end and *position == ',') {
+                position++;
+            } else {
+                line_is_over = true;
+            }
+        }
+        if (object_index < num_objects) {
+            report("expected " + std::to_string(num_objects) + " values (--objects), found " +
+                   std::to_string(object_index));
+            return false;
+        }
+        max_extra_columns = std::max(max_extra_columns, object_index - num_objects);
+        if (position < end and *position == '\r') {
+            position++;
+        }
+        if (position < end) {
+            position++;
         }
+        line_start = position;
+        line_number++;
         slot_index++;
     }
-    file.close();
+
+    if (slot_index < num_total_slots) {
+        std::cerr << availability_matrix_filename << ": expected " << num_total_slots
+                  << " lines (--days * --slots), found " << slot_index << std::endl;
+        return false;
+    }
+    if (max_extra_columns > 0) {
+        std::cerr << availability_matrix_filename << ": has up to " << max_extra_columns
+                  << " columns more than --objects, they are ignored" << std::endl;
+    }
+    while (position < end and (*position == '\n' or *position == '\r')) {
+        position++;
+    }
+    if (position < end) {
+        std::cerr << availability_matrix_filename << ": lines after " << num_total_slots
+                  << " (--days * --slots) are ignored" << std::endl;
+    }
+    return true;
+}
+
+// Detects the binary format by its magic, otherwise parses the file as CSV
+bool
+load_matrix_from_file(const std::string& availability_matrix_filename,
+                      AvailabilityMatrix& availability_matrix)
+{
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    if (not file->open(availability_matrix_filename)) {
+        std::cerr << "Can't open file " << availability_matrix_filename << std::endl;
+        return false;
+    }
+    if (is_binary_matrix(*file)) {
+        return load_matrix_from_binary(availability_matrix_filename, std::move(file),
+                                       availability_matrix);
+    }
+    return load_matrix_from_csv(availability_matrix_filename, *file, availability_matrix);
+}
+
+// convert mode: writes the --matrix file in the binary format to --output
+bool
+convert_matrix()
+{
+    AvailabilityMatrix availability_matrix;
+    if (not load_matrix_from_file(availability_matrix_filename, availability_matrix)) {
+        return false;
+    }
+    if (not save_matrix_to_binary(output_filename, availability_matrix)) {
+        return false;
+    }
+    LOG(INFO) << "Converted " << availability_matrix_filename << " to " << output_filename;
+    return true;
 }
 
 void
@@ -84,392 +538,3505 @@ load_vector_from_file(const std::string& objects_type_filename, std::vector<bool
     std::string line;
     int index = 0;
 
-    while (std::getline(file, line) && index < objects_type.size()) {
+    while (std::getline(file, line) && index < int(objects_type.size())) {
         objects_type[index] = (std::stoi(line) == 1);
         index++;
     }
     file.close();
 }
 
+// One non-negative integer weight per line, objects after the last line keep weight 1
 bool
-validate_solution(operations_research::sat::CpSolverResponse response,
-                  operations_research::sat::BoolVar* schedule,
-                  std::vector<bool>& availability_matrix,
-                  std::vector<bool>& objects_type)
+load_object_weights(const std::string& weights_filename, std::vector<int64_t>& object_weights)
 {
-    // Can watch object if availability_matrix[slot_index][object_index] is true
-    bool is_object_viewed;
-    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
-        for (int object_index = 0; object_index < num_objects; object_index++) {
-            is_object_viewed = SolutionBooleanValue(
-              response, schedule[slot_index * num_objects + object_index]);
-            if (not availability_matrix[slot_index * num_objects + object_index] and
-                is_object_viewed) {
-                std::cerr << "CANT WATCH THIS OBJECT IN THIS SLOTS" << std::endl;
-                std::cerr << "slot: " << slot_index << " object: " << object_index << std::endl;
-                return false;
-            }
-        }
+    std::ifstream file(weights_filename);
+    if (not file.is_open()) {
+        std::cerr << "Can't open file " << weights_filename << std::endl;
+        return false;
     }
-
-    // Can't watch more than 1 object_index in slot
-    std::vector<bool> slots(num_total_slots);
-    bool slot_is_busy = false;
-    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
-        slot_is_busy = false;
-        slots[slot_index] = false;
-        for (int object_index = 0; object_index < num_objects; object_index++) {
-            if (not availability_matrix[slot_index * num_objects + object_index]) {
-                continue;
-            }
-            is_object_viewed = SolutionBooleanValue(
-              response, schedule[slot_index * num_objects + object_index]);
-            if (not is_object_viewed) {
-                continue;
-            }
-            if (slot_is_busy) {
-                std::cerr << "SLOT IS BUSY" << std::endl;
-                std::cerr << "slot: " << slot_index << std::endl;
-                return false;
-            }
-            slot_is_busy = true;
-            slots[slot_index] = true;
+    std::string line;
+    int object_index = 0;
+    while (std::getline(file, line) and (object_index < num_objects)) {
+        int64_t weight;
+        std::istringstream line_stream(line);
+        if (not (line_stream >> weight) or weight < 0) {
+            std::cerr << weights_filename << ":" << object_index + 1
+                      << ": expected a non-negative integer, found '" << line << "'" << std::endl;
+            return false;
         }
+        object_weights[object_index++] = weight;
     }
+    return true;
+}
 
-    int left_slots_sum, rigth_slots_sum;
-    for (int day_index = 0; day_index < num_days; day_index++) {
-        left_slots_sum = 0;
-        rigth_slots_sum = 0;
+int
+object_daily_views_requirement(const std::vector<bool>& objects_type, int object_index)
+{
+    return objects_type[object_index] ? daily_views_requirement_type_a
+                                      : daily_views_requirement_type_b;
+}
 
-        for (int slot_index = daily_slots_window_size + 1; slot_index < num_daily_slots;
-             slot_index++) {
-            rigth_slots_sum += slots[day_index * num_daily_slots + slot_index];
-        }
-
-        for (int shift = 0; shift < num_daily_slots - daily_slots_window_size - 1; shift++) {
-            left_slots_sum += slots[day_index * num_daily_slots + shift];
-            rigth_slots_sum -=
-              slots[day_index * num_daily_slots + shift + daily_slots_window_size + 1];
-            if ((left_slots_sum > 0) and (rigth_slots_sum > 0)) {
-                std::cerr << "WINDOW SIZE IS EXCEEDED" << std::endl;
-                std::cerr << "day: " << day_index << std::endl;
-                std::cerr << "shift: " << shift << std::endl;
-                std::cerr << "left: " << left_slots_sum << std::endl;
-                std::cerr << "rigth: " << rigth_slots_sum << std::endl;
-                return false;
-            }
-        }
-    }
+int
+object_days_requirement(const std::vector<bool>& objects_type, int object_index)
+{
+    return objects_type[object_index] ? days_requirement_type_a : days_requirement_type_b;
+}
 
-    int daily_views_requirement;
-    int days_requirement;
-    int num_object_daily_views;
-    int* objects_days_num = new int[num_objects];
-    bool* is_object_viewed_in_day = new bool[num_days * num_objects];
-    int global_slot_index;
+bool
+has_geometric_progression()
+{
+    return (days_requirement_type_b > 1) and (progression_ratio > 1);
+}
 
-    for (int object_index = 0; object_index < num_objects; object_index++) {
-        objects_days_num[object_index] = 0;
+// Day offsets of the type B views from the first viewed day: 0, 1, 1 + r, 1 + r + r^2, ...
+std::vector<int>
+progression_day_shifts()
+{
+    std::vector<int> day_shifts(1, 0);
+    int current_progression_element = 1;
+    for (int progression_index = 0; progression_index < days_requirement_type_b - 1;
+         progression_index++) {
+        day_shifts.push_back(day_shifts.back() + current_progression_element);
+        current_progression_element *= progression_ratio;
     }
+    return day_shifts;
+}
+
+// The prefix encoding keeps type B objects out of this many last days of the horizon
+int
+prefix_excluded_days()
+{
+    return pow(progression_ratio, days_requirement_type_b - 1) / (progression_ratio - 1);
+}
 
+struct PresolveResult
+{
+    // is_day_usable[day_index * num_objects + object_index] is 0 when the object
+    // can't be viewed in the day by any schedule
+    std::vector<uint8_t> is_day_usable;
+    std::vector<int> unschedulable_objects;
+    int64_t removed_day_variables = 0;
+    int64_t removed_cells = 0;
+    int64_t removed_constraints = 0;
+};
+
+// Works on the matrix and object types only: marks (day, object) pairs that
+// can't be part of any schedule, clears their cells in the matrix and finds
+// objects that can't meet their requirements at all
+void
+presolve(AvailabilityMatrix& availability_matrix,
+         const std::vector<bool>& objects_type,
+         PresolveResult& result)
+{
+    result.is_day_usable.assign(num_days * num_objects, 0);
+    result.unschedulable_objects.clear();
+
+    // Views of a day have to fit into daily_slots_window_size consecutive slots
+    int window_size = std::min(daily_slots_window_size, num_daily_slots);
+    std::vector<int> window_views(num_objects);
+    std::vector<int> max_window_views(num_objects);
     for (int day_index = 0; day_index < num_days; day_index++) {
-        for (int object_index = 0; object_index < num_objects; object_index++) {
-            num_object_daily_views = 0;
-            for (int day_slot_index = 0; day_slot_index < num_daily_slots; day_slot_index++) {
-                global_slot_index = day_index * num_daily_slots + day_slot_index;
-                is_object_viewed = SolutionBooleanValue(
-                  response, schedule[global_slot_index * num_objects + object_index]);
-                num_object_daily_views += is_object_viewed;
-            }
-            is_object_viewed_in_day[day_index * num_objects + object_index] = (num_object_daily_views > 0);
-            if (num_object_daily_views == 0) {
-                continue;
+        std::fill(window_views.begin(), window_views.end(), 0);
+        std::fill(max_window_views.begin(), max_window_views.end(), 0);
+        int first_day_slot = day_index * num_daily_slots;
+        for (int slot_index = 0; slot_index < num_daily_slots; slot_index++) {
+            availability_matrix.for_each_available(first_day_slot + slot_index,
+                                                   [&](int object_index) {
+                window_views[object_index]++;
+            });
+            if (slot_index >= window_size) {
+                availability_matrix.for_each_available(
+                  first_day_slot + slot_index - window_size,
+                  [&](int object_index) { window_views[object_index]--; });
+            }
+            for (int object_index = 0; object_index < num_objects; object_index++) {
+                max_window_views[object_index] =
+                  std::max(max_window_views[object_index], window_views[object_index]);
             }
+        }
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            result.is_day_usable[day_index * num_objects + object_index] =
+              max_window_views[object_index] >=
+              object_daily_views_requirement(objects_type, object_index);
+        }
+    }
+
+    // Type B object is viewed exactly in the days of one progression,
+    // so a day is usable only if some fully usable progression covers it
+    if (has_geometric_progression()) {
+        std::vector<int> day_shifts = progression_day_shifts();
+        std::vector<uint8_t> is_covered(num_days);
+        for (int object_index = 0; object_index < num_objects; object_index++) {
             if (objects_type[object_index]) {
-                daily_views_requirement = daily_views_requirement_type_a;
-                days_requirement = days_requirement_type_a;
-            } else {
-                daily_views_requirement = daily_views_requirement_type_b;
-                days_requirement = days_requirement_type_b;
+                continue;
             }
-            if (num_object_daily_views == daily_views_requirement) {
-                objects_days_num[object_index] += 1;
-                if (objects_days_num[object_index] <= days_requirement) {
+            std::fill(is_covered.begin(), is_covered.end(), 0);
+            for (int start_day = 0; start_day + day_shifts.back() < num_days; start_day++) {
+                bool is_start_usable = true;
+                for (int day_shift : day_shifts) {
+                    is_start_usable = is_start_usable and
+                      result.is_day_usable[(start_day + day_shift) * num_objects + object_index];
+                }
+                if (not is_start_usable) {
                     continue;
                 }
-                std::cerr << "DAYS LIMIT IS EXCEEDED" << std::endl;
-                std::cerr << "object " << object_index << " have "
-                          << objects_days_num[object_index] << " but limit is " << days_requirement
-                          << std::endl;
+                for (int day_shift : day_shifts) {
+                    is_covered[start_day + day_shift] = 1;
+                }
+            }
+            for (int day_index = 0; day_index < num_days; day_index++) {
+                result.is_day_usable[day_index * num_objects + object_index] &=
+                  is_covered[day_index];
             }
-            std::cerr << "DAILY VIEWS INCORRECT COUNT" << std::endl;
-            std::cerr << "object " << object_index << " have " << num_object_daily_views
-                      << " in day " << day_index << " but correct value is "
-                      << daily_views_requirement << std::endl;
         }
     }
 
     for (int object_index = 0; object_index < num_objects; object_index++) {
-        if (objects_type[object_index]) {
-            days_requirement = days_requirement_type_a;
-        } else {
-            days_requirement = days_requirement_type_b;
+        int num_usable_days = 0;
+        for (int day_index = 0; day_index < num_days; day_index++) {
+            num_usable_days += result.is_day_usable[day_index * num_objects + object_index];
         }
-        if (objects_days_num[object_index] == days_requirement) {
-            continue;
+        if (num_usable_days < object_days_requirement(objects_type, object_index)) {
+            result.unschedulable_objects.push_back(object_index);
         }
-        std::cerr << "DAYS COUNT IS INCORRECT" << std::endl;
-        std::cerr << "object " << object_index << " have " << objects_days_num[object_index]
-                  << " but needed " << days_requirement << std::endl;
     }
 
-    // Geometric progression
-    if ((days_requirement_type_b > 1) and (progression_ratio > 1)){
-        int current_progression_element;
-        int current_day_shift;    
-        for (int object_index = 0; object_index < num_objects; object_index++) {
-            if (objects_type[object_index]) {
-                continue;
-            }
-            for (int day_index = 0; day_index < num_days; day_index++){
-                if (not is_object_viewed_in_day[day_index * num_objects + object_index]){
+    // Drop cells of unusable days
+    for (int day_index = 0; day_index < num_days; day_index++) {
+        for (int slot_index = 0; slot_index < num_daily_slots; slot_index++) {
+            int global_slot_index = day_index * num_daily_slots + slot_index;
+            uint64_t* slot_words =
+              &availability_matrix.words[size_t(global_slot_index) * availability_matrix.words_per_slot];
+            for (int object_index = 0; object_index < num_objects; object_index++) {
+                if (result.is_day_usable[day_index * num_objects + object_index]) {
                     continue;
                 }
-                current_progression_element = 1;
-                current_day_shift = 0;
-                for (int progression_index = 0; progression_index < days_requirement_type_b - 1; progression_index++){
-                    current_day_shift += current_progression_element;
-                    if ((day_index + current_day_shift) >= num_days) {
-                        std::cerr << "GEOMETRIC PROGRESSION OUT OF RANGE" << std::endl;
-                        std::cerr << "object " << object_index << " statred viewed in " << day_index
-                                  << " and have to be viewed in " << day_index + current_day_shift
-                                  << " but last day is " << num_days - 1 
-                                  << std::endl;
-                        return false;
-                    }
-                    if (not is_object_viewed_in_day[(day_index + current_day_shift) * num_objects + object_index]) {
-                        std::cerr << "INCORRECT GEOMETRIC PROGRESSION" << std::endl;
-                        std::cerr << "object " << object_index << " statred viewed in " << day_index
-                                  << " and have to be viewed in " << day_index + current_day_shift
-                                  << std::endl;
-                        return false;
-                    }
-                    current_progression_element *= progression_ratio;
+                uint64_t bit = uint64_t(1) << (object_index & 63);
+                if (slot_words[object_index >> 6] & bit) {
+                    slot_words[object_index >> 6] &= ~bit;
+                    result.removed_cells++;
                 }
-                break;
             }
         }
     }
-    return true;
-}
 
-namespace operations_research {
-namespace sat {
+    for (int index = 0; index < num_days * num_objects; index++) {
+        result.removed_day_variables += not result.is_day_usable[index];
+    }
+}
 
+// Clears the cells of the days outside [first_allowed_day, last_allowed_day] and of the blocked slots
 void
-generate_schedule()
+apply_blackouts(AvailabilityMatrix& availability_matrix)
 {
+    int last_day = last_allowed_day < 0 ? num_days - 1 : last_allowed_day;
+    std::vector<uint8_t> is_blocked(num_total_slots, 0);
+    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+        int day_index = slot_index / num_daily_slots;
+        is_blocked[slot_index] = (day_index < first_allowed_day) or (day_index > last_day);
+    }
+    for (const std::pair<int, int>& slot_range : blocked_slots) {
+        for (int slot_index = std::max(slot_range.first, 0);
+             slot_index <= std::min(slot_range.second, num_total_slots - 1); slot_index++) {
+            is_blocked[slot_index] = 1;
+        }
+    }
+    int num_blocked_slots = 0;
+    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+        if (is_blocked[slot_index]) {
+            std::fill_n(&availability_matrix.words[size_t(slot_index) * availability_matrix.words_per_slot],
+                        availability_matrix.words_per_slot, 0);
+            num_blocked_slots++;
+        }
+    }
+    if (num_blocked_slots > 0) {
+        LOG(INFO) << num_blocked_slots << " slots are blacked out";
+    }
+}
 
-    // Load data from files
-    std::vector<bool> availability_matrix(num_total_slots * num_objects);
-    load_matrix_from_file(availability_matrix_filename, availability_matrix);
-    std::vector<bool> objects_type(num_objects);
-    load_vector_from_file(objects_type_filename, objects_type);
+// Max flow by Dinic's algorithm. After max_flow, level[node] >= 0 marks
+// the nodes reachable from the source in the residual network, the source side of a minimum cut
+struct FlowNetwork
+{
+    struct Edge
+    {
+        int to;
+        int capacity;
+    };
 
-    CpModelBuilder cp_model;
+    // Edges 2k and 2k + 1 are reverse of each other
+    std::vector<Edge> edges;
+    std::vector<std::vector<int>> node_edges;
+    std::vector<int> level;
+    std::vector<int> next_edge;
 
-    BoolVar* schedule = new BoolVar[num_total_slots * num_objects];
+    explicit FlowNetwork(int num_nodes) : node_edges(num_nodes), level(num_nodes), next_edge(num_nodes) {}
 
-    // Can watch object if availability_matrix[slot_index][object_index] is 1
-    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
-        for (int object_index = 0; object_index < num_objects; object_index++) {
-            if (availability_matrix[slot_index * num_objects + object_index]) {
-                schedule[slot_index * num_objects + object_index] = cp_model.NewBoolVar();
-            } else {
-                schedule[slot_index * num_objects + object_index] = cp_model.FalseVar();
+    void add_edge(int from, int to, int capacity)
+    {
+        node_edges[from].push_back(edges.size());
+        edges.push_back({to, capacity});
+        node_edges[to].push_back(edges.size());
+        edges.push_back({from, 0});
+    }
+
+    bool build_levels(int source, int sink)
+    {
+        std::fill(level.begin(), level.end(), -1);
+        std::vector<int> queue(1, source);
+        level[source] = 0;
+        for (size_t queue_index = 0; queue_index < queue.size(); queue_index++) {
+            int node = queue[queue_index];
+            for (int edge_index : node_edges[node]) {
+                const Edge& edge = edges[edge_index];
+                if ((edge.capacity > 0) and (level[edge.to] < 0)) {
+                    level[edge.to] = level[node] + 1;
+                    queue.push_back(edge.to);
+                }
             }
         }
+        return level[sink] >= 0;
     }
 
-    LinearExpr* slots = new LinearExpr[num_total_slots];
-
-    LinearExpr only_one = LinearExpr(1);
-
-    // Can't watch more than 1 object in slotstd::cout << "#";
-    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
-        LinearExpr slots_object_count;
-        for (int object_index = 0; object_index < num_objects; object_index++) {
-            if (not availability_matrix[slot_index * num_objects + object_index]) {
+    int push(int node, int sink, int flow)
+    {
+        if (node == sink) {
+            return flow;
+        }
+        for (int& edge_number = next_edge[node]; edge_number < int(node_edges[node].size()); edge_number++) {
+            int edge_index = node_edges[node][edge_number];
+            Edge& edge = edges[edge_index];
+            if ((edge.capacity <= 0) or (level[edge.to] != level[node] + 1)) {
                 continue;
             }
-            slots_object_count += schedule[slot_index * num_objects + object_index];
+            int pushed = push(edge.to, sink, std::min(flow, edge.capacity));
+            if (pushed > 0) {
+                edge.capacity -= pushed;
+                edges[edge_index ^ 1].capacity += pushed;
+                return pushed;
+            }
         }
-        slots[slot_index] = slots_object_count;
-        cp_model.AddLessOrEqual(slots_object_count, only_one);
+        return 0;
     }
 
-    // Can use slots in window size daily_slots_window_size
-    LinearExpr exterior_sum;
-    int slot_global_index_1;
-    int slot_global_index_2;
-    for (int day_index = 0; day_index < num_days; day_index++) {
-        for (int slot_index_1 = 0; slot_index_1 < num_daily_slots - daily_slots_window_size;
-             slot_index_1++) {
-            for (int slot_index_2 = slot_index_1 + daily_slots_window_size;
-                 slot_index_2 < num_daily_slots;
-                 slot_index_2++) {
-                slot_global_index_1 = day_index * num_daily_slots + slot_index_1;
-                slot_global_index_2 = day_index * num_daily_slots + slot_index_2;
-                exterior_sum = slots[slot_global_index_1] + slots[slot_global_index_2];
-                cp_model.AddLessOrEqual(exterior_sum, only_one);
+    int64_t max_flow(int source, int sink)
+    {
+        int64_t flow = 0;
+        while (build_levels(source, sink)) {
+            std::fill(next_edge.begin(), next_edge.end(), 0);
+            while (int pushed = push(source, sink, std::numeric_limits<int>::max())) {
+                flow += pushed;
             }
         }
+        return flow;
     }
+};
 
-    LinearExpr* daily_object_views = new LinearExpr[num_days * num_objects];
-    BoolVar* is_object_viewed_in_day = new BoolVar[num_days * num_objects];
-    LinearExpr* total_object_days = new LinearExpr[num_objects];
+std::string
+format_index_list(const std::vector<int>& objects)
+{
+    const size_t max_listed_objects = 10;
+    std::ostringstream list;
+    for (size_t index = 0; index < std::min(objects.size(), max_listed_objects); index++) {
+        list << (index == 0 ? "" : ", ") << objects[index];
+    }
+    if (objects.size() > max_listed_objects) {
+        list << " and " << objects.size() - max_listed_objects << " more";
+    }
+    return list.str();
+}
 
-    for (int day_index = 0; day_index < num_days; day_index++) {
-        for (int object_index = 0; object_index < num_objects; object_index++) {
-            is_object_viewed_in_day[day_index * num_objects + object_index] =
-              cp_model.NewBoolVar();
-        }
+// Necessary conditions on the matrix and object types, checked before a model is built:
+// every object has enough days with its daily views visible, all required views fit into
+// the windows of the days, and the views fit as a flow
+// source -> object -> (object, day) -> slot -> day -> sink,
+// with the daily views, slot exclusivity and the window size as capacities.
+// Logs the reason and returns false when a condition is violated
+bool
+precheck_feasibility(const AvailabilityMatrix& availability_matrix,
+                     const std::vector<bool>& objects_type,
+                     const std::vector<uint8_t>& is_day_usable)
+{
+    int day_capacity = std::min(daily_slots_window_size, num_daily_slots);
+    std::vector<int> day_shifts = progression_day_shifts();
+
+    // Available slots of the object in usable days
+    std::vector<int> object_day_slots(size_t(num_days) * num_objects, 0);
+    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+        int day_index = slot_index / num_daily_slots;
+        availability_matrix.for_each_available(slot_index, [&](int object_index) {
+            object_day_slots[size_t(day_index) * num_objects + object_index] +=
+              is_day_usable[day_index * num_objects + object_index];
+        });
     }
+    auto is_day_open = [&](int day_index, int object_index) {
+        return std::min(object_day_slots[size_t(day_index) * num_objects + object_index], day_capacity) >=
+               object_daily_views_requirement(objects_type, object_index);
+    };
 
-    // Control of objects daily views
-    int daily_views;
-    for (int day_index = 0; day_index < num_days; day_index++) {
-        for (int object_index = 0; object_index < num_objects; object_index++) {
-            daily_object_views[day_index * num_objects + object_index] = LinearExpr();
-            for (int slot_index = 0; slot_index < num_daily_slots; slot_index++) {
-                int global_slot_index = day_index * num_daily_slots + slot_index;
-                if (not availability_matrix[global_slot_index * num_objects + object_index]) {
-                    continue;
+    bool is_feasible = true;
+    int64_t total_views = 0;
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        int days_requirement = object_days_requirement(objects_type, object_index);
+        int daily_views = object_daily_views_requirement(objects_type, object_index);
+        total_views += int64_t(days_requirement) * daily_views;
+        if (not objects_type[object_index] and has_geometric_progression()) {
+            bool has_start = false;
+            for (int start_day = 0; (start_day + day_shifts.back() < num_days) and not has_start; start_day++) {
+                has_start = true;
+                for (int day_shift : day_shifts) {
+                    has_start = has_start and is_day_open(start_day + day_shift, object_index);
                 }
-                daily_object_views[day_index * num_objects + object_index] +=
-                  schedule[global_slot_index * num_objects + object_index];
             }
-
-            if (objects_type[object_index]) {
-                daily_views = daily_views_requirement_type_a;
-            } else {
-                daily_views = daily_views_requirement_type_b;
+            if (not has_start) {
+                LOG(INFO) << "Precheck: object " << object_index << " has no progression of "
+                          << days_requirement << " days with " << daily_views << " visible slots a day";
+                is_feasible = false;
             }
-
-            cp_model.AddEquality(
-              daily_views * is_object_viewed_in_day[day_index * num_objects + object_index],
-              daily_object_views[day_index * num_objects + object_index]);
-            total_object_days[object_index] +=
-              is_object_viewed_in_day[day_index * num_objects + object_index];
+            continue;
+        }
+        int num_open_days = 0;
+        for (int day_index = 0; day_index < num_days; day_index++) {
+            num_open_days += is_day_open(day_index, object_index);
         }
+        if (num_open_days < days_requirement) {
+            LOG(INFO) << "Precheck: object " << object_index << " has " << daily_views
+                      << " visible slots in " << num_open_days << " days, needs " << days_requirement;
+            is_feasible = false;
+        }
+    }
+    if (not is_feasible) {
+        return false;
     }
 
-    // Objects days limit
-    int num_object_days;
-    LinearExpr days_requirement_type_a_lin_exp = LinearExpr(days_requirement_type_a);
-    LinearExpr days_requirement_type_b_lin_exp = LinearExpr(days_requirement_type_b);
-    LinearExpr days_requirement_lin_exp;
-    for (int object_index = 0; object_index < num_objects; object_index++) {
-        if (objects_type[object_index]) {
-            days_requirement_lin_exp = days_requirement_type_a_lin_exp;
-        } else {
-            days_requirement_lin_exp = days_requirement_type_b_lin_exp;
-        }
-        cp_model.AddEquality(total_object_days[object_index], days_requirement_lin_exp);
+    if (total_views > int64_t(num_days) * day_capacity) {
+        LOG(INFO) << "Precheck: objects need " << total_views << " views, " << num_days
+                  << " days hold at most " << int64_t(num_days) * day_capacity << " in windows of "
+                  << day_capacity << " slots";
+        return false;
     }
 
-    // Geometry progression
-    if ((days_requirement_type_b > 1) and (progression_ratio > 1)){
-        int current_progression_element;
-        int current_day_shift;
-        int max_day_shift = pow(progression_ratio, days_requirement_type_b - 1) / (progression_ratio - 1);
-        LinearExpr* object_days_prexif_sum = new LinearExpr[num_days * num_objects];
-
-        // Prefix sum
-        for (int day_index = 1; day_index < num_days - max_day_shift; day_index++){
-            for (int object_index = 0; object_index < num_objects; object_index++) {
-                if (objects_type[object_index]) {
-                    continue;
-                }
-                object_days_prexif_sum[day_index * num_objects + object_index] = 
-                    object_days_prexif_sum[(day_index - 1) * num_objects + object_index]
-                    + is_object_viewed_in_day[(day_index - 1) * num_objects + object_index];
+    // Nodes: source, objects, (object, day) pairs with visible slots, slots, days, sink
+    int source = 0;
+    int first_object_node = 1;
+    int first_slot_node = first_object_node + num_objects;
+    int first_day_node = first_slot_node + num_total_slots;
+    int sink = first_day_node + num_days;
+    std::vector<int> object_day_node(size_t(num_days) * num_objects, -1);
+    int num_nodes = sink + 1;
+    for (int day_index = 0; day_index < num_days; day_index++) {
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            if (is_day_open(day_index, object_index)) {
+                object_day_node[size_t(day_index) * num_objects + object_index] = num_nodes++;
             }
         }
-
-        // Checking for compliance with the geometric progression
-        for (int day_index = 0; day_index < num_days - max_day_shift; day_index++){
-            for (int object_index = 0; object_index < num_objects; object_index++) {
-                if (objects_type[object_index]) {
+    }
+    FlowNetwork network(num_nodes);
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        network.add_edge(source, first_object_node + object_index,
+                         object_days_requirement(objects_type, object_index) *
+                           object_daily_views_requirement(objects_type, object_index));
+    }
+    for (int day_index = 0; day_index < num_days; day_index++) {
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            int node = object_day_node[size_t(day_index) * num_objects + object_index];
+            if (node >= 0) {
+                network.add_edge(first_object_node + object_index, node,
+                                 object_daily_views_requirement(objects_type, object_index));
+            }
+        }
+        network.add_edge(first_day_node + day_index, sink, day_capacity);
+    }
+    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+        int day_index = slot_index / num_daily_slots;
+        availability_matrix.for_each_available(slot_index, [&](int object_index) {
+            int node = object_day_node[size_t(day_index) * num_objects + object_index];
+            if (node >= 0) {
+                network.add_edge(node, first_slot_node + slot_index, 1);
+            }
+        });
+        network.add_edge(first_slot_node + slot_index, first_day_node + day_index, 1);
+    }
+    int64_t max_views = network.max_flow(source, sink);
+    if (max_views == total_views) {
+        return true;
+    }
+
+    // Objects on the source side of the minimum cut compete for the same full slots and days
+    std::vector<int> bottleneck_objects;
+    int64_t bottleneck_views = 0;
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        if (network.level[first_object_node + object_index] >= 0) {
+            bottleneck_objects.push_back(object_index);
+            bottleneck_views += object_days_requirement(objects_type, object_index) *
+                                object_daily_views_requirement(objects_type, object_index);
+        }
+    }
+    std::vector<int> full_days;
+    for (int day_index = 0; day_index < num_days; day_index++) {
+        if (network.level[first_day_node + day_index] >= 0) {
+            full_days.push_back(day_index);
+        }
+    }
+    LOG(INFO) << "Precheck: at most " << max_views << " of " << total_views
+              << " required views fit into free slots and day windows";
+    LOG(INFO) << "Precheck: objects " << format_index_list(bottleneck_objects) << " need "
+              << bottleneck_views << " views, only " << bottleneck_views - (total_views - max_views)
+              << " fit into their visible slots"
+              << (full_days.empty() ? "" : " and the full windows of days " + format_index_list(full_days));
+    return false;
+}
+
+// Viewed (slot, object) cells of a schedule, sorted by slot and object
+struct Schedule
+{
+    std::vector<std::pair<int, int>> views;
+
+    void sort() { std::sort(views.begin(), views.end()); }
+};
+
+// day_index and object_index are -1 when the violation isn't tied to a day or an object
+struct Violation
+{
+    std::string kind;
+    int day_index;
+    int object_index;
+    std::string message;
+};
+
+void
+add_violation(std::vector<Violation>& violations,
+              const std::string& kind,
+              int day_index,
+              int object_index,
+              const std::string& message)
+{
+    violations.push_back({kind, day_index, object_index, message});
+}
+
+// Checks a schedule in one pass over its views. Slot order gives days in order, so
+// per-day state is kept for the current day only and the progression is followed as days come
+std::vector<Violation>
+find_violations(const Schedule& schedule,
+                const AvailabilityMatrix& availability_matrix,
+                const std::vector<bool>& objects_type,
+                bool allow_unscheduled_objects = false)
+{
+    std::vector<Violation> violations;
+    std::vector<int> day_shifts = progression_day_shifts();
+    bool check_window = num_daily_slots > daily_slots_window_size;
+
+    std::vector<int> objects_days_num(num_objects, 0);
+    std::vector<int> first_viewed_day(num_objects, -1);
+    std::vector<int> daily_views(num_objects, 0);
+    std::vector<int> viewed_objects;
+    int current_day = -1;
+    int first_used_slot = 0;
+    int last_used_slot = 0;
+    int previous_slot = -1;
+
+    auto finish_day = [&]() {
+        if (current_day < 0) {
+            return;
+        }
+        if (check_window and (last_used_slot - first_used_slot >= daily_slots_window_size)) {
+            add_violation(violations, "WINDOW SIZE IS EXCEEDED", current_day, -1,
+                          "day " + std::to_string(current_day) + " uses slots " +
+                            std::to_string(first_used_slot) + " and " +
+                            std::to_string(last_used_slot) + ", window is " +
+                            std::to_string(daily_slots_window_size));
+        }
+        for (int object_index : viewed_objects) {
+            int required_views = object_daily_views_requirement(objects_type, object_index);
+            if (daily_views[object_index] != required_views) {
+                add_violation(violations, "DAILY VIEWS INCORRECT COUNT", current_day, object_index,
+                              "object " + std::to_string(object_index) + " have " +
+                                std::to_string(daily_views[object_index]) + " in day " +
+                                std::to_string(current_day) + " but correct value is " +
+                                std::to_string(required_views));
+            }
+            daily_views[object_index] = 0;
+
+            int days_num = objects_days_num[object_index]++;
+            if (days_num == object_days_requirement(objects_type, object_index)) {
+                add_violation(violations, "DAYS LIMIT IS EXCEEDED", current_day, object_index,
+                              "object " + std::to_string(object_index) + " is viewed in day " +
+                                std::to_string(current_day) + " after " +
+                                std::to_string(days_num) + " days");
+            }
+            if (days_num == 0) {
+                first_viewed_day[object_index] = current_day;
+            } else if (not objects_type[object_index] and has_geometric_progression() and
+                       days_num < int(day_shifts.size()) and
+                       current_day != first_viewed_day[object_index] + day_shifts[days_num]) {
+                add_violation(violations, "INCORRECT GEOMETRIC PROGRESSION", current_day, object_index,
+                              "object " + std::to_string(object_index) + " statred viewed in " +
+                                std::to_string(first_viewed_day[object_index]) +
+                                " and have to be viewed in " +
+                                std::to_string(first_viewed_day[object_index] + day_shifts[days_num]) +
+                                " but viewed in " + std::to_string(current_day));
+            }
+        }
+        viewed_objects.clear();
+    };
+
+    for (const std::pair<int, int>& view : schedule.views) {
+        int slot_index = view.first;
+        int object_index = view.second;
+        if (not availability_matrix.is_available(slot_index, object_index)) {
+            add_violation(violations, "CANT WATCH THIS OBJECT IN THIS SLOTS", slot_index / num_daily_slots, object_index,
+                          "slot: " + std::to_string(slot_index) +
+                            " object: " + std::to_string(object_index));
+        }
+        if (slot_index == previous_slot) {
+            add_violation(violations, "SLOT IS BUSY", slot_index / num_daily_slots, object_index,
+                          "slot: " + std::to_string(slot_index) +
+                            " object: " + std::to_string(object_index));
+        }
+        previous_slot = slot_index;
+
+        int day_index = slot_index / num_daily_slots;
+        int day_slot_index = slot_index % num_daily_slots;
+        if (day_index != current_day) {
+            finish_day();
+            current_day = day_index;
+            first_used_slot = day_slot_index;
+        }
+        last_used_slot = day_slot_index;
+        if (daily_views[object_index]++ == 0) {
+            viewed_objects.push_back(object_index);
+        }
+    }
+    finish_day();
+
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        int days_requirement = object_days_requirement(objects_type, object_index);
+        if ((objects_days_num[object_index] >= days_requirement) or
+            (allow_unscheduled_objects and (objects_days_num[object_index] == 0))) {
+            continue;
+        }
+        add_violation(violations, "DAYS COUNT IS INCORRECT", -1, object_index,
+                      "object " + std::to_string(object_index) + " have " +
+                        std::to_string(objects_days_num[object_index]) + " but needed " +
+                        std::to_string(days_requirement));
+        int last_progression_day = first_viewed_day[object_index] + day_shifts.back();
+        if (not objects_type[object_index] and has_geometric_progression() and
+            (first_viewed_day[object_index] >= 0) and (last_progression_day >= num_days)) {
+            add_violation(violations, "GEOMETRIC PROGRESSION OUT OF RANGE", -1, object_index,
+                          "object " + std::to_string(object_index) + " statred viewed in " +
+                            std::to_string(first_viewed_day[object_index]) +
+                            " and have to be viewed in " + std::to_string(last_progression_day) +
+                            " but last day is " + std::to_string(num_days - 1));
+        }
+    }
+    return violations;
+}
+
+// Reports every violation of the schedule, true when there are none.
+// Partial schedules may leave objects without views with allow_unscheduled_objects
+bool
+validate_solution(const Schedule& schedule,
+                  const AvailabilityMatrix& availability_matrix,
+                  const std::vector<bool>& objects_type,
+                  bool allow_unscheduled_objects = false)
+{
+    std::vector<Violation> violations =
+      find_violations(schedule, availability_matrix, objects_type, allow_unscheduled_objects);
+    for (const Violation& violation : violations) {
+        std::cerr << violation.kind << std::endl;
+        std::cerr << violation.message << std::endl;
+    }
+    if (not violations.empty()) {
+        std::cerr << violations.size() << " violations found" << std::endl;
+    }
+    return violations.empty();
+}
+
+// Reads either sparse "slot,object" lines, the "Day N" / "# . # ." grid the scheduler prints
+// or a binary schedule in the availability matrix format.
+// Empty lines are skipped. In the sparse format so are "#" and lines starting with "# ",
+// in the grid every other line is a row, even when it starts with '#'
+bool
+load_schedule_from_file(const std::string& schedule_filename, Schedule& schedule)
+{
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    if (not file->open(schedule_filename)) {
+        std::cerr << "Can't open file " << schedule_filename << std::endl;
+        return false;
+    }
+    schedule.views.clear();
+    if (is_binary_matrix(*file)) {
+        AvailabilityMatrix schedule_matrix;
+        if (not load_matrix_from_binary(schedule_filename, std::move(file), schedule_matrix)) {
+            return false;
+        }
+        for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+            schedule_matrix.for_each_available(slot_index, [&](int object_index) {
+                schedule.views.emplace_back(slot_index, object_index);
+            });
+        }
+        return true;
+    }
+    const char* position = file->data;
+    const char* end = file->data + file->size;
+    int line_number = 0;
+    bool is_grid = false;
+    int grid_slot_index = 0;
+
+    auto report = [&](const std::string& message) {
+        std::cerr << schedule_filename << ":" << line_number << ": " << message << std::endl;
+    };
+
+    while (position < end) {
+        const char* line_end = std::find(position, end, '\n');
+        std::string line(position, line_end);
+        position = (line_end < end) ? line_end + 1 : end;
+        line_number++;
+        if (not line.empty() and line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (line.compare(0, 4, "Day ") == 0) {
+            is_grid = true;
+            continue;
+        }
+        if (is_grid) {
+            if (grid_slot_index >= num_total_slots) {
+                report("more than " + std::to_string(num_total_slots) + " slots (--days * --slots)");
+                return false;
+            }
+            int object_index = 0;
+            for (char cell : line) {
+                if (cell == ' ') {
+                    continue;
+                }
+                if ((cell != '#' and cell != '.') or object_index >= num_objects) {
+                    report("expected " + std::to_string(num_objects) + " '#' or '.' cells");
+                    return false;
+                }
+                if (cell == '#') {
+                    schedule.views.emplace_back(grid_slot_index, object_index);
+                }
+                object_index++;
+            }
+            if (object_index != num_objects) {
+                report("expected " + std::to_string(num_objects) + " cells, found " +
+                       std::to_string(object_index));
+                return false;
+            }
+            grid_slot_index++;
+            continue;
+        }
+        if ((line.compare(0, 2, "# ") == 0) or (line == "#") or (line == "slot,object")) {
+            continue;
+        }
+        int slot_index, object_index;
+        char separator;
+        std::istringstream line_stream(line);
+        if (not (line_stream >> slot_index >> separator >> object_index) or separator != ',') {
+            report("expected 'slot,object', found '" + line + "'");
+            return false;
+        }
+        if (slot_index < 0 or slot_index >= num_total_slots or object_index < 0 or
+            object_index >= num_objects) {
+            report("slot " + std::to_string(slot_index) + " or object " +
+                   std::to_string(object_index) + " is out of range");
+            return false;
+        }
+        schedule.views.emplace_back(slot_index, object_index);
+    }
+    schedule.sort();
+    return true;
+}
+
+// Writes filename.tmp and renames it over filename, so the file always holds a whole schedule
+bool
+save_schedule_to_file(const std::string& filename, const Schedule& schedule)
+{
+    std::string temporary_filename = filename + ".tmp";
+    if (output_format == BINARY_OUTPUT_FORMAT) {
+        AvailabilityMatrix schedule_matrix;
+        schedule_matrix.resize(num_total_slots, num_objects);
+        for (const std::pair<int, int>& view : schedule.views) {
+            schedule_matrix.set_available(view.first, view.second);
+        }
+        if (not save_matrix_to_binary(temporary_filename, schedule_matrix)) {
+            return false;
+        }
+    } else {
+        std::string text = "# days " + std::to_string(num_days) + " slots " + std::to_string(num_daily_slots) +
+                           " objects " + std::to_string(num_objects) + "\nslot,object\n";
+        text.reserve(text.size() + schedule.views.size() * 12);
+        for (const std::pair<int, int>& view : schedule.views) {
+            text += std::to_string(view.first);
+            text += ',';
+            text += std::to_string(view.second);
+            text += '\n';
+        }
+        std::ofstream file(temporary_filename, std::ios::binary | std::ios::trunc);
+        if (not file.is_open()) {
+            std::cerr << "Can't open file " << temporary_filename << std::endl;
+            return false;
+        }
+        file.write(text.data(), text.size());
+        file.close();
+        if (not file.good()) {
+            std::cerr << "Can't write file " << temporary_filename << std::endl;
+            return false;
+        }
+    }
+    if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Can't replace file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Loads the --hint schedule. hinted_cells keeps only views that are still available,
+// is_object_fixed marks objects whose hinted views are all available and violate nothing
+bool
+prepare_hint(const AvailabilityMatrix& availability_matrix,
+             const std::vector<bool>& objects_type,
+             AvailabilityMatrix& hinted_cells,
+             std::vector<uint8_t>& is_object_fixed)
+{
+    Schedule hint_schedule;
+    if (not load_schedule_from_file(hint_filename, hint_schedule)) {
+        return false;
+    }
+    hinted_cells.resize(num_total_slots, num_objects);
+    is_object_fixed.assign(num_objects, hint_mode == FIX_HINT_MODE);
+    int num_dropped_views = 0;
+    for (const std::pair<int, int>& view : hint_schedule.views) {
+        if (availability_matrix.is_available(view.first, view.second)) {
+            hinted_cells.set_available(view.first, view.second);
+        } else {
+            num_dropped_views++;
+        }
+    }
+
+    int num_fixed_objects = 0;
+    if (hint_mode == FIX_HINT_MODE) {
+        std::vector<uint8_t> is_day_violated(num_days, 0);
+        for (const Violation& violation :
+             find_violations(hint_schedule, availability_matrix, objects_type)) {
+            if (violation.object_index >= 0) {
+                is_object_fixed[violation.object_index] = 0;
+            } else if (violation.day_index >= 0) {
+                is_day_violated[violation.day_index] = 1;
+            }
+        }
+        for (const std::pair<int, int>& view : hint_schedule.views) {
+            if (is_day_violated[view.first / num_daily_slots]) {
+                is_object_fixed[view.second] = 0;
+            }
+        }
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            num_fixed_objects += is_object_fixed[object_index];
+        }
+    }
+    LOG(INFO) << "Hint: " << hint_schedule.views.size() - num_dropped_views << " views, "
+              << num_dropped_views << " views are no longer available"
+              << (hint_mode == FIX_HINT_MODE
+                    ? ", " + std::to_string(num_fixed_objects) + " objects fixed"
+                    : "");
+    return true;
+}
+
+// validate mode: checks a stored schedule against the --matrix and --types files
+bool
+validate_schedule_file()
+{
+    AvailabilityMatrix availability_matrix;
+    if (not load_matrix_from_file(availability_matrix_filename, availability_matrix)) {
+        return false;
+    }
+    std::vector<bool> objects_type(num_objects);
+    load_vector_from_file(objects_type_filename, objects_type);
+    Schedule schedule;
+    if (not load_schedule_from_file(schedule_filename, schedule)) {
+        return false;
+    }
+    bool is_valid = validate_solution(schedule, availability_matrix, objects_type);
+    LOG(INFO) << schedule_filename << (is_valid ? " is valid" : " is not valid");
+    return is_valid;
+}
+
+namespace operations_research {
+namespace sat {
+
+// Number of variable and literal occurrences in a constraint
+int64_t
+count_constraint_terms(const ConstraintProto& constraint)
+{
+    return constraint.enforcement_literal_size() + constraint.linear().vars_size() +
+           constraint.bool_or().literals_size() + constraint.at_most_one().literals_size() +
+           constraint.exactly_one().literals_size();
+}
+
+// Number of variable and literal occurrences in all constraints
+int64_t
+count_model_terms(const CpModelProto& model_proto)
+{
+    int64_t num_terms = 0;
+    for (const ConstraintProto& constraint : model_proto.constraints()) {
+        num_terms += count_constraint_terms(constraint);
+    }
+    return num_terms;
+}
+
+// Peak resident set size of the process so far
+int64_t
+peak_rss_kb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+std::string
+json_escape(const std::string& value)
+{
+    std::string escaped;
+    for (char symbol : value) {
+        if (symbol == '"' or symbol == '\\') {
+            escaped += '\\';
+        }
+        escaped += symbol;
+    }
+    return escaped;
+}
+
+// Wall time of every pipeline phase, and for model building phases the
+// variables, constraints and terms the phase added to the model
+struct PhaseStats
+{
+    std::string name;
+    double seconds = 0;
+    bool has_model_counts = false;
+    int64_t variables = 0;
+    int64_t constraints = 0;
+    int64_t terms = 0;
+    int64_t peak_rss_kb = 0;
+};
+
+// Objective and bound of a best-effort solve when a solution is found
+struct ProgressPoint
+{
+    double seconds = 0;
+    double objective = 0;
+    double bound = 0;
+};
+
+struct PipelineStats
+{
+    std::vector<PhaseStats> phases;
+    std::vector<ProgressPoint> progress;
+    // Status of the last report
+    std::string status;
+    int64_t model_variables = 0;
+    int64_t model_constraints = 0;
+    int64_t model_terms = 0;
+    std::chrono::steady_clock::time_point pipeline_start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point phase_start = pipeline_start;
+    int num_counted_variables = 0;
+    int num_counted_constraints = 0;
+
+    void start_phase() { phase_start = std::chrono::steady_clock::now(); }
+
+    PhaseStats& end_phase(const std::string& name)
+    {
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - phase_start;
+        phases.emplace_back();
+        phases.back().name = name;
+        phases.back().seconds = duration.count();
+        phases.back().peak_rss_kb = peak_rss_kb();
+        phase_start = std::chrono::steady_clock::now();
+        return phases.back();
+    }
+
+    // Counts only what was added to the model since the previous model phase
+    PhaseStats& end_model_phase(const std::string& name, const CpModelProto& model_proto)
+    {
+        PhaseStats& phase = end_phase(name);
+        phase.has_model_counts = true;
+        phase.variables = model_proto.variables_size() - num_counted_variables;
+        phase.constraints = model_proto.constraints_size() - num_counted_constraints;
+        for (int constraint_index = num_counted_constraints;
+             constraint_index < model_proto.constraints_size(); constraint_index++) {
+            phase.terms += count_constraint_terms(model_proto.constraints(constraint_index));
+        }
+        num_counted_variables = model_proto.variables_size();
+        num_counted_constraints = model_proto.constraints_size();
+        phase_start = std::chrono::steady_clock::now();
+        return phase;
+    }
+
+    // Sum of the phases building the model
+    double build_seconds() const
+    {
+        double seconds = 0;
+        for (const PhaseStats& phase : phases) {
+            seconds += (phase.has_model_counts or phase.name == "build") ? phase.seconds : 0;
+        }
+        return seconds;
+    }
+
+    double phase_seconds(const std::string& name) const
+    {
+        double seconds = 0;
+        for (const PhaseStats& phase : phases) {
+            seconds += (phase.name == name) ? phase.seconds : 0;
+        }
+        return seconds;
+    }
+
+    double total_seconds() const
+    {
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - pipeline_start;
+        return duration.count();
+    }
+};
+
+PipelineStats pipeline_stats;
+
+bool
+write_stats_json(const std::string& filename, const std::string& status)
+{
+    std::ofstream file(filename, std::ios::trunc);
+    if (not file.is_open()) {
+        std::cerr << "Can't open file " << filename << std::endl;
+        return false;
+    }
+    file << "{\n";
+    file << "  \"parameters\": {\"days\": " << num_days << ", \"slots\": " << num_daily_slots
+         << ", \"objects\": " << num_objects << ", \"window_size\": " << daily_slots_window_size
+         << ", \"a_days\": " << days_requirement_type_a << ", \"b_days\": " << days_requirement_type_b
+         << ", \"a_views\": " << daily_views_requirement_type_a
+         << ", \"b_views\": " << daily_views_requirement_type_b
+         << ", \"ratio\": " << progression_ratio
+         << ", \"window_encoding\": \"" << json_escape(window_encoding) << "\""
+         << ", \"progression_encoding\": \"" << json_escape(progression_encoding) << "\""
+         << ", \"presolve\": " << (use_presolve ? "true" : "false")
+         << ", \"workers\": " << num_workers
+         << ", \"matrix\": \"" << json_escape(availability_matrix_filename) << "\""
+         << ", \"types\": \"" << json_escape(objects_type_filename) << "\"},\n";
+    file << "  \"status\": \"" << json_escape(status) << "\",\n";
+    file << "  \"total_seconds\": " << pipeline_stats.total_seconds() << ",\n";
+    file << "  \"build_seconds\": " << pipeline_stats.build_seconds() << ",\n";
+    file << "  \"solve_seconds\": " << pipeline_stats.phase_seconds("solve") << ",\n";
+    file << "  \"model\": {\"variables\": " << pipeline_stats.model_variables
+         << ", \"constraints\": " << pipeline_stats.model_constraints
+         << ", \"terms\": " << pipeline_stats.model_terms << "},\n";
+    file << "  \"peak_rss_kb\": " << peak_rss_kb() << ",\n";
+    file << "  \"phases\": [";
+    for (size_t phase_index = 0; phase_index < pipeline_stats.phases.size(); phase_index++) {
+        const PhaseStats& phase = pipeline_stats.phases[phase_index];
+        file << (phase_index == 0 ? "\n" : ",\n");
+        file << "    {\"name\": \"" << json_escape(phase.name) << "\", \"seconds\": " << phase.seconds
+             << ", \"peak_rss_kb\": " << phase.peak_rss_kb;
+        if (phase.has_model_counts) {
+            file << ", \"variables\": " << phase.variables << ", \"constraints\": "
+                 << phase.constraints << ", \"terms\": " << phase.terms;
+        }
+        file << "}";
+    }
+    file << "\n  ],\n";
+    file << "  \"progress\": [";
+    for (size_t point_index = 0; point_index < pipeline_stats.progress.size(); point_index++) {
+        const ProgressPoint& point = pipeline_stats.progress[point_index];
+        file << (point_index == 0 ? "\n" : ",\n");
+        file << "    {\"seconds\": " << point.seconds << ", \"objective\": " << point.objective
+             << ", \"bound\": " << point.bound << "}";
+    }
+    file << "\n  ]\n}\n";
+    return file.good();
+}
+
+// Logs the phases and writes --stats-json if it is requested
+void
+report_pipeline_stats(const std::string& status)
+{
+    for (const PhaseStats& phase : pipeline_stats.phases) {
+        LOG(INFO) << "Phase " << phase.name << ": " << phase.seconds << " s"
+                  << (phase.has_model_counts
+                        ? ", " + std::to_string(phase.variables) + " variables, " +
+                            std::to_string(phase.constraints) + " constraints, " +
+                            std::to_string(phase.terms) + " terms"
+                        : "");
+    }
+    LOG(INFO) << "Peak RSS: " << peak_rss_kb() << " KB";
+    pipeline_stats.status = status;
+    if (not stats_json_filename.empty()) {
+        write_stats_json(stats_json_filename, status);
+    }
+}
+
+SatParameters
+make_solver_parameters()
+{
+    SatParameters parameters;
+    // Explicit flags override the same fields of the pass-through text
+    google::protobuf::TextFormat::MergeFromString(sat_parameters_text, &parameters);
+
+    if (num_workers > 0) {
+        parameters.set_num_workers(num_workers);
+    } else if (not parameters.has_num_workers()) {
+        parameters.set_num_workers(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    if (random_seed >= 0) {
+        parameters.set_random_seed(random_seed);
+    }
+    if (deterministic_search) {
+        // Interleaved search gives the same result for any number of workers,
+        // limit deterministic time so the stop point doesn't depend on machine load.
+        // Wall time isn't capped then, a loaded machine can take longer than --time_limit seconds
+        parameters.set_interleave_search(true);
+        if (time_limit_seconds > 0) {
+            parameters.set_max_deterministic_time(time_limit_seconds);
+        }
+    } else if (time_limit_seconds > 0) {
+        parameters.set_max_time_in_seconds(time_limit_seconds);
+    }
+    if (not hint_filename.empty() and (hint_mode == REPAIR_HINT_MODE)) {
+        parameters.set_repair_hint(true);
+    }
+    return parameters;
+}
+
+// Writes variables and constraints straight into a CpModelProto.
+// A literal is a variable index, its negation is -index - 1
+struct ProtoModelBuilder
+{
+    CpModelProto proto;
+    // Fixed to 1, false is its negation
+    int true_literal = 0;
+
+    ProtoModelBuilder()
+    {
+        true_literal = new_int_var(1, 1);
+    }
+
+    ProtoModelBuilder(const ProtoModelBuilder&) = default;
+    ProtoModelBuilder(ProtoModelBuilder&&) = default;
+    ProtoModelBuilder& operator=(const ProtoModelBuilder&) = default;
+    ProtoModelBuilder& operator=(ProtoModelBuilder&&) = default;
+
+    // Constraints only builder sharing the variables of model
+    static ProtoModelBuilder fragment_of(const ProtoModelBuilder& model)
+    {
+        ProtoModelBuilder fragment;
+        fragment.proto.Clear();
+        fragment.true_literal = model.true_literal;
+        return fragment;
+    }
+
+    static int negated(int literal)
+    {
+        return -literal - 1;
+    }
+
+    int false_literal() const
+    {
+        return negated(true_literal);
+    }
+
+    void reserve(int num_variables, int num_constraints)
+    {
+        proto.mutable_variables()->Reserve(proto.variables_size() + num_variables);
+        proto.mutable_constraints()->Reserve(proto.constraints_size() + num_constraints);
+    }
+
+    int new_int_var(int64_t lower_bound, int64_t upper_bound)
+    {
+        IntegerVariableProto* variable = proto.add_variables();
+        variable->add_domain(lower_bound);
+        variable->add_domain(upper_bound);
+        return proto.variables_size() - 1;
+    }
+
+    int new_bool_var()
+    {
+        return new_int_var(0, 1);
+    }
+
+    // lower_bound <= sum of the terms <= upper_bound, terms are added with add_term
+    ConstraintProto* add_linear(int64_t lower_bound, int64_t upper_bound)
+    {
+        ConstraintProto* constraint = proto.add_constraints();
+        constraint->mutable_linear()->add_domain(lower_bound);
+        constraint->mutable_linear()->add_domain(upper_bound);
+        return constraint;
+    }
+
+    // Constant and negated literals are moved into the bounds
+    void add_term(ConstraintProto* constraint, int reference, int64_t coefficient)
+    {
+        LinearConstraintProto* linear = constraint->mutable_linear();
+        int64_t constant = 0;
+        if (reference == true_literal) {
+            constant = coefficient;
+        } else if (reference == false_literal()) {
+            return;
+        } else if (reference < 0) {
+            constant = coefficient;
+            linear->add_vars(negated(reference));
+            linear->add_coeffs(-coefficient);
+        } else {
+            linear->add_vars(reference);
+            linear->add_coeffs(coefficient);
+        }
+        if (constant != 0) {
+            linear->set_domain(0, linear->domain(0) - constant);
+            linear->set_domain(1, linear->domain(1) - constant);
+        }
+    }
+
+    ConstraintProto* add_at_most_one()
+    {
+        ConstraintProto* constraint = proto.add_constraints();
+        constraint->mutable_at_most_one();
+        return constraint;
+    }
+
+    ConstraintProto* add_exactly_one()
+    {
+        ConstraintProto* constraint = proto.add_constraints();
+        constraint->mutable_exactly_one();
+        return constraint;
+    }
+
+    ConstraintProto* add_bool_or()
+    {
+        ConstraintProto* constraint = proto.add_constraints();
+        constraint->mutable_bool_or();
+        return constraint;
+    }
+
+    // False literals never change a clause, at most one or exactly one
+    void add_literal(BoolArgumentProto* argument, int literal)
+    {
+        if (literal != false_literal()) {
+            argument->add_literals(literal);
+        }
+    }
+
+    void add_hint(int literal, bool value)
+    {
+        if (literal == true_literal or literal == false_literal()) {
+            return;
+        }
+        if (literal < 0) {
+            literal = negated(literal);
+            value = not value;
+        }
+        proto.mutable_solution_hint()->add_vars(literal);
+        proto.mutable_solution_hint()->add_values(value);
+    }
+
+    // CP-SAT minimizes, maximization is a negated objective with scaling factor -1
+    void add_maximized_term(int literal, int64_t coefficient)
+    {
+        CpObjectiveProto* objective = proto.mutable_objective();
+        objective->set_scaling_factor(-1);
+        if (literal == true_literal or literal == false_literal()) {
+            return;
+        }
+        if (literal < 0) {
+            objective->set_offset(objective->offset() - coefficient);
+            objective->add_vars(negated(literal));
+            objective->add_coeffs(coefficient);
+        } else {
+            objective->add_vars(literal);
+            objective->add_coeffs(-coefficient);
+        }
+    }
+};
+
+// Calls build(fragment, begin, end, removed_constraints) for contiguous chunks of [0, num_items)
+// on num_build_threads threads, then appends the fragments in chunk order. Every item has to emit
+// the same constraints wherever its chunk starts, so the model doesn't depend on the thread count
+template <typename Builder>
+void
+add_constraints_in_parallel(ProtoModelBuilder& model,
+                            int num_build_threads,
+                            int num_items,
+                            int64_t& removed_constraints,
+                            Builder build)
+{
+    int num_chunks = std::max(1, std::min(num_build_threads, num_items));
+    std::vector<ProtoModelBuilder> fragments(num_chunks, ProtoModelBuilder::fragment_of(model));
+    std::vector<int64_t> chunks_removed_constraints(num_chunks, 0);
+    auto build_chunk = [&](int chunk_index) {
+        build(fragments[chunk_index],
+              int(int64_t(num_items) * chunk_index / num_chunks),
+              int(int64_t(num_items) * (chunk_index + 1) / num_chunks),
+              chunks_removed_constraints[chunk_index]);
+    };
+    std::vector<std::thread> threads;
+    for (int chunk_index = 1; chunk_index < num_chunks; chunk_index++) {
+        threads.emplace_back(build_chunk, chunk_index);
+    }
+    build_chunk(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    int num_constraints = 0;
+    for (const ProtoModelBuilder& fragment : fragments) {
+        num_constraints += fragment.proto.constraints_size();
+    }
+    model.proto.mutable_constraints()->Reserve(model.proto.constraints_size() + num_constraints);
+    for (int chunk_index = 0; chunk_index < num_chunks; chunk_index++) {
+        CpModelProto& fragment_proto = fragments[chunk_index].proto;
+        for (int constraint_index = 0; constraint_index < fragment_proto.constraints_size(); constraint_index++) {
+            model.proto.add_constraints()->Swap(fragment_proto.mutable_constraints(constraint_index));
+        }
+        fragment_proto.Clear();
+        removed_constraints += chunks_removed_constraints[chunk_index];
+    }
+}
+
+bool
+literal_value(const CpSolverResponse& response, int literal)
+{
+    if (literal < 0) {
+        return response.solution(-literal - 1) == 0;
+    }
+    return response.solution(literal) == 1;
+}
+
+// Literals of the days [first_day, last_day) of a model
+struct DayRangeModel
+{
+    int first_day = 0;
+    int last_day = 0;
+    // Cells that can be watched, in slot order. Cells of the range slot s are
+    // [slot_begin[s], slot_begin[s + 1]), cells that are fixed to 0 are not stored
+    std::vector<int> slot_begin;
+    std::vector<int> cell_object;
+    std::vector<int> cell_literal;
+    // (day_index - first_day) * num_objects + object_index
+    std::vector<int> day_literal;
+    // Window constraints of the range day are enforced by the literal when it is set
+    std::vector<int> day_window_literal;
+
+    int& day(int day_index, int object_index)
+    {
+        return day_literal[(day_index - first_day) * num_objects + object_index];
+    }
+};
+
+Schedule
+extract_schedule(const CpSolverResponse& response,
+                 const DayRangeModel& range,
+                 int last_day)
+{
+    Schedule schedule;
+    int first_slot = range.first_day * num_daily_slots;
+    for (int slot_index = first_slot; slot_index < last_day * num_daily_slots; slot_index++) {
+        for (int cell_index = range.slot_begin[slot_index - first_slot];
+             cell_index < range.slot_begin[slot_index - first_slot + 1];
+             cell_index++) {
+            if (literal_value(response, range.cell_literal[cell_index])) {
+                schedule.views.emplace_back(slot_index, range.cell_object[cell_index]);
+            }
+        }
+    }
+    return schedule;
+}
+
+// Adds everything that is local to a day for the days of the range: cell literals,
+// slot exclusivity, the window and daily views. hinted_cells may be null,
+// objects with is_object_fixed get constant cells taken from hinted_cells
+void
+add_day_range_constraints(ProtoModelBuilder& model,
+                          const AvailabilityMatrix& availability_matrix,
+                          const std::vector<bool>& objects_type,
+                          const std::vector<uint8_t>& is_day_usable,
+                          const AvailabilityMatrix* hinted_cells,
+                          const std::vector<uint8_t>& is_object_fixed,
+                          PipelineStats* phase_stats,
+                          int num_build_threads,
+                          PresolveResult& presolve_result,
+                          DayRangeModel& range)
+{
+    int range_days = range.last_day - range.first_day;
+    int range_slots = range_days * num_daily_slots;
+    int first_slot = range.first_day * num_daily_slots;
+    bool use_hint = hinted_cells != nullptr;
+
+    // Can watch object if availability_matrix[slot_index][object_index] is 1 and the day is usable
+    range.slot_begin.assign(range_slots + 1, 0);
+    range.cell_object.clear();
+    range.cell_literal.clear();
+    for (int range_slot_index = 0; range_slot_index < range_slots; range_slot_index++) {
+        int slot_index = first_slot + range_slot_index;
+        int day_index = slot_index / num_daily_slots;
+        availability_matrix.for_each_available(slot_index, [&](int object_index) {
+            if (not is_day_usable[day_index * num_objects + object_index]) {
+                return;
+            }
+            if (is_object_fixed[object_index] and
+                not hinted_cells->is_available(slot_index, object_index)) {
+                return;
+            }
+            range.cell_object.push_back(object_index);
+        });
+        range.slot_begin[range_slot_index + 1] = range.cell_object.size();
+    }
+    int num_cells = range.cell_object.size();
+    model.reserve(num_cells + range_days * num_objects + range_slots + 2 * range_days,
+                  3 * range_slots + range_days * num_objects);
+
+    range.cell_literal.resize(num_cells);
+    for (int range_slot_index = 0; range_slot_index < range_slots; range_slot_index++) {
+        int slot_index = first_slot + range_slot_index;
+        for (int cell_index = range.slot_begin[range_slot_index];
+             cell_index < range.slot_begin[range_slot_index + 1];
+             cell_index++) {
+            int object_index = range.cell_object[cell_index];
+            if (is_object_fixed[object_index]) {
+                range.cell_literal[cell_index] = model.true_literal;
+                continue;
+            }
+            range.cell_literal[cell_index] = model.new_bool_var();
+            if (use_hint) {
+                model.add_hint(range.cell_literal[cell_index],
+                               hinted_cells->is_available(slot_index, object_index));
+            }
+        }
+    }
+    if (phase_stats != nullptr) {
+        phase_stats->end_model_phase("cell_variables", model.proto);
+    }
+
+    // The linear window encoding needs a "slot is used" literal per slot
+    bool use_linear_window = (window_encoding == LINEAR_WINDOW_ENCODING) and
+                             (num_daily_slots > daily_slots_window_size);
+    std::vector<int> slot_is_used;
+    if (use_linear_window) {
+        slot_is_used.assign(range_slots, model.false_literal());
+    }
+
+    // Variables are created up front, constraint families are built in parallel
+    for (int range_slot_index = 0; use_linear_window and (range_slot_index < range_slots);
+         range_slot_index++) {
+        if (range.slot_begin[range_slot_index] == range.slot_begin[range_slot_index + 1]) {
+            continue;
+        }
+        slot_is_used[range_slot_index] = model.new_bool_var();
+        if (use_hint) {
+            bool is_slot_hinted = false;
+            hinted_cells->for_each_available(first_slot + range_slot_index, [&](int) {
+                is_slot_hinted = true;
+            });
+            model.add_hint(slot_is_used[range_slot_index], is_slot_hinted);
+        }
+    }
+
+    // Can't watch more than 1 object in slot
+    add_constraints_in_parallel(model, num_build_threads, range_slots, presolve_result.removed_constraints,
+                                [&](ProtoModelBuilder& fragment, int begin, int end,
+                                    int64_t& removed_constraints) {
+        for (int range_slot_index = begin; range_slot_index < end; range_slot_index++) {
+            int cells_begin = range.slot_begin[range_slot_index];
+            int cells_end = range.slot_begin[range_slot_index + 1];
+            if (cells_begin == cells_end) {
+                // Nobody can be watched in the slot
+                removed_constraints++;
+                continue;
+            }
+            ConstraintProto* constraint;
+            if (use_linear_window) {
+                // Exactly one of the cells and "slot is not used"
+                constraint = fragment.add_exactly_one();
+                fragment.add_literal(constraint->mutable_exactly_one(),
+                                     ProtoModelBuilder::negated(slot_is_used[range_slot_index]));
+                for (int cell_index = cells_begin; cell_index < cells_end; cell_index++) {
+                    fragment.add_literal(constraint->mutable_exactly_one(), range.cell_literal[cell_index]);
+                }
+            } else {
+                constraint = fragment.add_at_most_one();
+                for (int cell_index = cells_begin; cell_index < cells_end; cell_index++) {
+                    fragment.add_literal(constraint->mutable_at_most_one(), range.cell_literal[cell_index]);
+                }
+            }
+        }
+    });
+
+    if (phase_stats != nullptr) {
+        phase_stats->end_model_phase("slot_exclusivity", model.proto);
+    }
+
+    // Can use slots in window size daily_slots_window_size
+    if (use_linear_window) {
+        // Every used slot of the day lies between first_used_slot and last_used_slot,
+        // and they can't be daily_slots_window_size or more slots apart
+        std::vector<int> used_slot_bounds(2 * range_days);
+        for (int day_index = 0; day_index < range_days; day_index++) {
+            used_slot_bounds[2 * day_index] = model.new_int_var(0, num_daily_slots - 1);
+            used_slot_bounds[2 * day_index + 1] = model.new_int_var(0, num_daily_slots - 1);
+        }
+        add_constraints_in_parallel(model, num_build_threads, range_days, presolve_result.removed_constraints,
+                                    [&](ProtoModelBuilder& fragment, int begin, int end,
+                                        int64_t& removed_constraints) {
+            for (int day_index = begin; day_index < end; day_index++) {
+                int first_used_slot = used_slot_bounds[2 * day_index];
+                int last_used_slot = used_slot_bounds[2 * day_index + 1];
+                ConstraintProto* window = fragment.add_linear(std::numeric_limits<int64_t>::min(),
+                                                              daily_slots_window_size - 1);
+                if (not range.day_window_literal.empty()) {
+                    window->add_enforcement_literal(range.day_window_literal[day_index]);
+                }
+                fragment.add_term(window, last_used_slot, 1);
+                fragment.add_term(window, first_used_slot, -1);
+                for (int slot_index = 0; slot_index < num_daily_slots; slot_index++) {
+                    int range_slot_index = day_index * num_daily_slots + slot_index;
+                    if (range.slot_begin[range_slot_index] == range.slot_begin[range_slot_index + 1]) {
+                        removed_constraints += 2;
+                        continue;
+                    }
+                    ConstraintProto* first_bound = fragment.add_linear(0, slot_index);
+                    first_bound->add_enforcement_literal(slot_is_used[range_slot_index]);
+                    fragment.add_term(first_bound, first_used_slot, 1);
+                    ConstraintProto* last_bound = fragment.add_linear(slot_index, num_daily_slots - 1);
+                    last_bound->add_enforcement_literal(slot_is_used[range_slot_index]);
+                    fragment.add_term(last_bound, last_used_slot, 1);
+                }
+            }
+        });
+    } else {
+        add_constraints_in_parallel(model, num_build_threads, range_days, presolve_result.removed_constraints,
+                                    [&](ProtoModelBuilder& fragment, int begin, int end,
+                                        int64_t& removed_constraints) {
+            for (int day_index = begin; day_index < end; day_index++) {
+                for (int slot_index_1 = 0; slot_index_1 < num_daily_slots - daily_slots_window_size;
+                     slot_index_1++) {
+                    for (int slot_index_2 = slot_index_1 + daily_slots_window_size;
+                         slot_index_2 < num_daily_slots;
+                         slot_index_2++) {
+                        int slot_range_index_1 = day_index * num_daily_slots + slot_index_1;
+                        int slot_range_index_2 = day_index * num_daily_slots + slot_index_2;
+                        if ((range.slot_begin[slot_range_index_1] == range.slot_begin[slot_range_index_1 + 1]) or
+                            (range.slot_begin[slot_range_index_2] == range.slot_begin[slot_range_index_2 + 1])) {
+                            removed_constraints++;
+                            continue;
+                        }
+                        // At most one view in both slots together, at_most_one can't be enforced
+                        if (not range.day_window_literal.empty()) {
+                            ConstraintProto* exterior = fragment.add_linear(0, 1);
+                            exterior->add_enforcement_literal(range.day_window_literal[day_index]);
+                            for (int slot_range_index : {slot_range_index_1, slot_range_index_2}) {
+                                for (int cell_index = range.slot_begin[slot_range_index];
+                                     cell_index < range.slot_begin[slot_range_index + 1];
+                                     cell_index++) {
+                                    fragment.add_term(exterior, range.cell_literal[cell_index], 1);
+                                }
+                            }
+                            continue;
+                        }
+                        ConstraintProto* exterior = fragment.add_at_most_one();
+                        for (int slot_range_index : {slot_range_index_1, slot_range_index_2}) {
+                            for (int cell_index = range.slot_begin[slot_range_index];
+                                 cell_index < range.slot_begin[slot_range_index + 1];
+                                 cell_index++) {
+                                fragment.add_literal(exterior->mutable_at_most_one(),
+                                                     range.cell_literal[cell_index]);
+                            }
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    if (phase_stats != nullptr) {
+        phase_stats->end_model_phase("window", model.proto);
+    }
+
+    range.day_literal.assign(size_t(range_days) * num_objects, model.false_literal());
+    std::vector<uint8_t> is_object_hinted(num_objects, 0);
+    for (int day_index = range.first_day; day_index < range.last_day; day_index++) {
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            if (is_day_usable[day_index * num_objects + object_index]) {
+                range.day(day_index, object_index) = model.new_bool_var();
+            }
+        }
+        if (not use_hint) {
+            continue;
+        }
+        std::fill(is_object_hinted.begin(), is_object_hinted.end(), 0);
+        for (int slot_index = 0; slot_index < num_daily_slots; slot_index++) {
+            hinted_cells->for_each_available(day_index * num_daily_slots + slot_index,
+                                             [&](int object_index) {
+                is_object_hinted[object_index] = 1;
+            });
+        }
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            if (is_day_usable[day_index * num_objects + object_index]) {
+                model.add_hint(range.day(day_index, object_index), is_object_hinted[object_index]);
+            }
+        }
+    }
+
+    // Control of objects daily views, cells of the day are grouped by object first
+    add_constraints_in_parallel(model, num_build_threads, range_days, presolve_result.removed_constraints,
+                                [&](ProtoModelBuilder& fragment, int begin, int end,
+                                    int64_t& removed_constraints) {
+        std::vector<int> object_cells_begin(num_objects + 1);
+        std::vector<int> object_cells;
+        for (int day_index = range.first_day + begin; day_index < range.first_day + end; day_index++) {
+            int day_cells_begin = range.slot_begin[(day_index - range.first_day) * num_daily_slots];
+            int day_cells_end = range.slot_begin[(day_index - range.first_day + 1) * num_daily_slots];
+            std::fill(object_cells_begin.begin(), object_cells_begin.end(), 0);
+            for (int cell_index = day_cells_begin; cell_index < day_cells_end; cell_index++) {
+                object_cells_begin[range.cell_object[cell_index] + 1]++;
+            }
+            for (int object_index = 0; object_index < num_objects; object_index++) {
+                object_cells_begin[object_index + 1] += object_cells_begin[object_index];
+            }
+            object_cells.resize(day_cells_end - day_cells_begin);
+            for (int cell_index = day_cells_begin; cell_index < day_cells_end; cell_index++) {
+                object_cells[object_cells_begin[range.cell_object[cell_index]]++] = cell_index;
+            }
+            // Filling moved every begin to the next one
+            for (int object_index = num_objects; object_index > 0; object_index--) {
+                object_cells_begin[object_index] = object_cells_begin[object_index - 1];
+            }
+            object_cells_begin[0] = 0;
+
+            for (int object_index = 0; object_index < num_objects; object_index++) {
+                if (not is_day_usable[day_index * num_objects + object_index]) {
+                    // Cells of the day are removed, so it is 0 == 0
+                    removed_constraints++;
+                    continue;
+                }
+                int day_literal = range.day(day_index, object_index);
+                int daily_views = object_daily_views_requirement(objects_type, object_index);
+                if (daily_views == 1) {
+                    // Exactly one of the cells and "object is not viewed in the day"
+                    ConstraintProto* views = fragment.add_exactly_one();
+                    fragment.add_literal(views->mutable_exactly_one(), ProtoModelBuilder::negated(day_literal));
+                    for (int index = object_cells_begin[object_index];
+                         index < object_cells_begin[object_index + 1];
+                         index++) {
+                        fragment.add_literal(views->mutable_exactly_one(),
+                                             range.cell_literal[object_cells[index]]);
+                    }
+                    continue;
+                }
+                ConstraintProto* views = fragment.add_linear(0, 0);
+                fragment.add_term(views, day_literal, daily_views);
+                for (int index = object_cells_begin[object_index];
+                     index < object_cells_begin[object_index + 1];
+                     index++) {
+                    fragment.add_term(views, range.cell_literal[object_cells[index]], -1);
+                }
+            }
+        }
+    });
+
+    if (phase_stats != nullptr) {
+        phase_stats->end_model_phase("daily_views", model.proto);
+    }
+}
+
+// Whole horizon model: day constraints, exact days requirements and the geometric progression.
+// is_object_in_model may be null, otherwise objects outside of the model must have no usable days.
+// With object_weights or object_literals every object is either fully scheduled or not viewed
+// at all. The weight of scheduled objects is maximized, object_literals gets the literals
+void
+build_monolithic_model(ProtoModelBuilder& model,
+                       const AvailabilityMatrix& availability_matrix,
+                       const std::vector<bool>& objects_type,
+                       const AvailabilityMatrix* hinted_cells,
+                       const std::vector<uint8_t>& is_object_fixed,
+                       const std::vector<uint8_t>* is_object_in_model,
+                       const std::vector<int64_t>* object_weights,
+                       std::vector<int>* object_literals,
+                       PipelineStats* phase_stats,
+                       int num_build_threads,
+                       PresolveResult& presolve_result,
+                       DayRangeModel& range)
+{
+    const std::vector<uint8_t>& is_day_usable = presolve_result.is_day_usable;
+    range.first_day = 0;
+    range.last_day = num_days;
+    add_day_range_constraints(model, availability_matrix, objects_type, is_day_usable,
+                              hinted_cells, is_object_fixed, phase_stats, num_build_threads, presolve_result,
+                              range);
+
+    // Object is scheduled literals of the best-effort and diagnosis modes
+    std::vector<int> is_object_scheduled(num_objects, model.true_literal);
+    bool use_object_literals = (object_weights != nullptr) or (object_literals != nullptr);
+    for (int object_index = 0; use_object_literals and (object_index < num_objects); object_index++) {
+        if ((is_object_in_model != nullptr) and not (*is_object_in_model)[object_index]) {
+            continue;
+        }
+        is_object_scheduled[object_index] = model.new_bool_var();
+        if (object_weights != nullptr) {
+            model.add_maximized_term(is_object_scheduled[object_index], (*object_weights)[object_index]);
+        }
+        if (hinted_cells != nullptr) {
+            bool is_object_hinted = false;
+            for (int slot_index = 0; (slot_index < num_total_slots) and not is_object_hinted; slot_index++) {
+                is_object_hinted = hinted_cells->is_available(slot_index, object_index);
+            }
+            model.add_hint(is_object_scheduled[object_index], is_object_hinted);
+        }
+    }
+
+    if (object_literals != nullptr) {
+        *object_literals = is_object_scheduled;
+    }
+
+    // Objects days limit
+    add_constraints_in_parallel(model, num_build_threads, num_objects, presolve_result.removed_constraints,
+                                [&](ProtoModelBuilder& fragment, int begin, int end,
+                                    int64_t&) {
+        for (int object_index = begin; object_index < end; object_index++) {
+            if ((is_object_in_model != nullptr) and not (*is_object_in_model)[object_index]) {
+                continue;
+            }
+            int days_requirement = object_days_requirement(objects_type, object_index);
+            ConstraintProto* days_limit = fragment.add_linear(0, 0);
+            fragment.add_term(days_limit, is_object_scheduled[object_index], -days_requirement);
+            for (int day_index = 0; day_index < num_days; day_index++) {
+                fragment.add_term(days_limit, range.day(day_index, object_index), 1);
+            }
+        }
+    });
+    if (phase_stats != nullptr) {
+        phase_stats->end_model_phase("days_limit", model.proto);
+    }
+
+    // Geometry progression
+    if (has_geometric_progression() and (progression_encoding == PREFIX_PROGRESSION_ENCODING)) {
+        int max_day_shift = prefix_excluded_days();
+
+        // Checking for compliance with the geometric progression:
+        // w_{i} implies w_{i+shift} or one of w_{0} ... w_{i-1}
+        add_constraints_in_parallel(model, num_build_threads, std::max(0, num_days - max_day_shift),
+                                    presolve_result.removed_constraints,
+                                    [&](ProtoModelBuilder& fragment, int begin, int end,
+                                        int64_t& removed_constraints) {
+            int current_progression_element;
+            int current_day_shift;
+            for (int day_index = begin; day_index < end; day_index++){
+                for (int object_index = 0; object_index < num_objects; object_index++) {
+                    if (objects_type[object_index]) {
+                        continue;
+                    }
+                    if (not is_day_usable[day_index * num_objects + object_index]) {
+                        // w_{i} is false, so the constraints hold
+                        removed_constraints += days_requirement_type_b - 1;
+                        continue;
+                    }
+                    current_progression_element = 1;
+                    current_day_shift = 0;
+                    for (int progression_index = 0; progression_index < days_requirement_type_b - 1; progression_index++){
+                        current_day_shift += current_progression_element;
+
+                        ConstraintProto* progression = fragment.add_bool_or();
+                        progression->add_enforcement_literal(range.day(day_index, object_index));
+                        fragment.add_literal(progression->mutable_bool_or(),
+                                             range.day(day_index + current_day_shift, object_index));
+                        for (int previous_day_index = 0; previous_day_index < day_index; previous_day_index++) {
+                            fragment.add_literal(progression->mutable_bool_or(),
+                                                 range.day(previous_day_index, object_index));
+                        }
+
+                        current_progression_element *= progression_ratio;
+                    }
+                }
+            }
+        });
+
+        // Сan not use the last few days as the beginning of a sequence
+        for (int day_index = std::max(0, num_days - max_day_shift); day_index < num_days; day_index++){
+            for (int object_index = 0; object_index < num_objects; object_index++) {
+                if (objects_type[object_index]) {
+                    continue;
+                }
+                if (not is_day_usable[day_index * num_objects + object_index]) {
+                    presolve_result.removed_constraints++;
+                    continue;
+                }
+                // Realy bad realization, but will work
+                ConstraintProto* last_days = model.add_linear(0, 0);
+                model.add_term(last_days, range.day(day_index, object_index), 1);
+            }
+        }
+    }
+
+    // Start day encoding: one start day per type B object among the days whose whole
+    // progression is usable, a day is viewed exactly when a start covering it is chosen
+    if (has_geometric_progression() and (progression_encoding == START_PROGRESSION_ENCODING)) {
+        std::vector<int> day_shifts = progression_day_shifts();
+        std::vector<std::vector<std::pair<int, int>>> start_literals(num_objects);
+        int64_t num_removed_starts = 0;
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            if (objects_type[object_index] or
+                ((is_object_in_model != nullptr) and not (*is_object_in_model)[object_index])) {
+                continue;
+            }
+            int first_hinted_day = -1;
+            for (int slot_index = 0; (hinted_cells != nullptr) and (slot_index < num_total_slots) and
+                                     (first_hinted_day == -1);
+                 slot_index++) {
+                if (hinted_cells->is_available(slot_index, object_index)) {
+                    first_hinted_day = slot_index / num_daily_slots;
+                }
+            }
+            for (int start_day = 0; start_day + day_shifts.back() < num_days; start_day++) {
+                bool is_start_usable = true;
+                for (int day_shift : day_shifts) {
+                    is_start_usable = is_start_usable and
+                      is_day_usable[(start_day + day_shift) * num_objects + object_index];
+                }
+                if (not is_start_usable) {
+                    num_removed_starts++;
+                    continue;
+                }
+                start_literals[object_index].emplace_back(start_day, model.new_bool_var());
+                if (hinted_cells != nullptr) {
+                    model.add_hint(start_literals[object_index].back().second, start_day == first_hinted_day);
+                }
+            }
+        }
+        if (phase_stats == &pipeline_stats) {
+            LOG(INFO) << "Progression start days: " << num_removed_starts << " removed before the solve";
+        }
+
+        add_constraints_in_parallel(model, num_build_threads, num_objects, presolve_result.removed_constraints,
+                                    [&](ProtoModelBuilder& fragment, int begin, int end,
+                                        int64_t& removed_constraints) {
+            std::vector<int> start_literal_of_day(num_days);
+            for (int object_index = begin; object_index < end; object_index++) {
+                if (objects_type[object_index] or
+                    ((is_object_in_model != nullptr) and not (*is_object_in_model)[object_index])) {
+                    continue;
+                }
+                std::fill(start_literal_of_day.begin(), start_literal_of_day.end(), fragment.false_literal());
+                ConstraintProto* start = fragment.add_exactly_one();
+                fragment.add_literal(start->mutable_exactly_one(),
+                                     ProtoModelBuilder::negated(is_object_scheduled[object_index]));
+                for (const std::pair<int, int>& start_literal : start_literals[object_index]) {
+                    start_literal_of_day[start_literal.first] = start_literal.second;
+                    fragment.add_literal(start->mutable_exactly_one(), start_literal.second);
+                }
+                for (int day_index = 0; day_index < num_days; day_index++) {
+                    if (not is_day_usable[day_index * num_objects + object_index]) {
+                        removed_constraints++;
+                        continue;
+                    }
+                    ConstraintProto* covered = fragment.add_exactly_one();
+                    fragment.add_literal(covered->mutable_exactly_one(),
+                                         ProtoModelBuilder::negated(range.day(day_index, object_index)));
+                    for (int day_shift : day_shifts) {
+                        if (day_index - day_shift >= 0) {
+                            fragment.add_literal(covered->mutable_exactly_one(),
+                                                 start_literal_of_day[day_index - day_shift]);
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    if (phase_stats != nullptr) {
+        phase_stats->end_model_phase("geometric_progression", model.proto);
+    }
+}
+
+// Groups of at least two objects with the same type, weight and availability column.
+// Their schedules can be swapped, fixed objects are never grouped
+std::vector<std::vector<int>>
+find_identical_objects(const AvailabilityMatrix& availability_matrix,
+                       const std::vector<bool>& objects_type,
+                       const std::vector<int64_t>& object_weights,
+                       const std::vector<uint8_t>& is_object_fixed)
+{
+    std::vector<uint64_t> column_hash(num_objects, 14695981039346656037ull);
+    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+        availability_matrix.for_each_available(slot_index, [&](int object_index) {
+            column_hash[object_index] = (column_hash[object_index] ^ uint64_t(slot_index)) * 1099511628211ull;
+        });
+    }
+    std::vector<int> objects_order;
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        if (not is_object_fixed[object_index]) {
+            objects_order.push_back(object_index);
+        }
+    }
+    std::stable_sort(objects_order.begin(), objects_order.end(), [&](int left, int right) {
+        if (objects_type[left] != objects_type[right]) {
+            return objects_type[left] < objects_type[right];
+        }
+        if (object_weights[left] != object_weights[right]) {
+            return object_weights[left] < object_weights[right];
+        }
+        return column_hash[left] < column_hash[right];
+    });
+
+    // Objects with equal keys are checked cell by cell against the first one
+    std::vector<std::vector<int>> groups;
+    for (size_t begin = 0, end = 0; begin < objects_order.size(); begin = end) {
+        int first_object = objects_order[begin];
+        std::vector<int> group = {first_object};
+        for (end = begin + 1; end < objects_order.size(); end++) {
+            int object_index = objects_order[end];
+            if ((objects_type[object_index] != objects_type[first_object]) or
+                (object_weights[object_index] != object_weights[first_object]) or
+                (column_hash[object_index] != column_hash[first_object])) {
+                break;
+            }
+            bool is_identical = true;
+            for (int slot_index = 0; is_identical and (slot_index < num_total_slots); slot_index++) {
+                is_identical = availability_matrix.is_available(slot_index, object_index) ==
+                               availability_matrix.is_available(slot_index, first_object);
+            }
+            if (is_identical) {
+                group.push_back(object_index);
+            }
+        }
+        if (group.size() > 1) {
+            std::sort(group.begin(), group.end());
+            groups.push_back(group);
+        }
+    }
+    std::sort(groups.begin(), groups.end());
+    return groups;
+}
+
+// Days of consecutive objects of a group are ordered lexicographically, w_{a} >= w_{b}.
+// equal_k is true while the first k days are equal, then w_{a,k} >= w_{b,k}
+void
+add_symmetry_breaking(ProtoModelBuilder& model,
+                      DayRangeModel& range,
+                      const std::vector<std::vector<int>>& identical_objects,
+                      const std::vector<uint8_t>* is_object_in_model)
+{
+    for (const std::vector<int>& group : identical_objects) {
+        if ((is_object_in_model != nullptr) and not (*is_object_in_model)[group[0]]) {
+            continue;
+        }
+        for (size_t group_index = 0; group_index + 1 < group.size(); group_index++) {
+            int object_a = group[group_index];
+            int object_b = group[group_index + 1];
+            int equal_prefix = model.true_literal;
+            for (int day_index = 0; day_index < num_days; day_index++) {
+                int day_a = range.day(day_index, object_a);
+                int day_b = range.day(day_index, object_b);
+                if ((day_a == model.false_literal()) and (day_b == model.false_literal())) {
+                    continue;
+                }
+                ConstraintProto* greater = model.add_bool_or();
+                greater->add_enforcement_literal(equal_prefix);
+                model.add_literal(greater->mutable_bool_or(), day_a);
+                model.add_literal(greater->mutable_bool_or(), ProtoModelBuilder::negated(day_b));
+
+                int next_equal_prefix = model.new_bool_var();
+                ConstraintProto* both_viewed = model.add_bool_or();
+                both_viewed->add_enforcement_literal(equal_prefix);
+                both_viewed->add_enforcement_literal(day_a);
+                both_viewed->add_enforcement_literal(day_b);
+                model.add_literal(both_viewed->mutable_bool_or(), next_equal_prefix);
+                ConstraintProto* both_skipped = model.add_bool_or();
+                both_skipped->add_enforcement_literal(equal_prefix);
+                both_skipped->add_enforcement_literal(ProtoModelBuilder::negated(day_a));
+                model.add_literal(both_skipped->mutable_bool_or(), next_equal_prefix);
+                equal_prefix = next_equal_prefix;
+            }
+        }
+    }
+}
+
+// Swaps the hinted views inside groups of identical objects so that the hint
+// follows the lexicographic order of add_symmetry_breaking
+void
+order_identical_hint(AvailabilityMatrix& hinted_cells, const std::vector<std::vector<int>>& identical_objects)
+{
+    if (identical_objects.empty()) {
+        return;
+    }
+    std::vector<std::vector<uint8_t>> viewed_days(num_objects);
+    for (const std::vector<int>& group : identical_objects) {
+        for (int object_index : group) {
+            viewed_days[object_index].assign(num_days, 0);
+        }
+    }
+    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+        hinted_cells.for_each_available(slot_index, [&](int object_index) {
+            if (not viewed_days[object_index].empty()) {
+                viewed_days[object_index][slot_index / num_daily_slots] = 1;
+            }
+        });
+    }
+
+    // source_object[object] is the object whose views the object takes over
+    std::vector<int> source_object(num_objects);
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        source_object[object_index] = object_index;
+    }
+    for (const std::vector<int>& group : identical_objects) {
+        std::vector<int> sources = group;
+        std::stable_sort(sources.begin(), sources.end(), [&](int left, int right) {
+            return viewed_days[left] > viewed_days[right];
+        });
+        for (size_t group_index = 0; group_index < group.size(); group_index++) {
+            source_object[group[group_index]] = sources[group_index];
+        }
+    }
+    std::vector<int> target_object(num_objects);
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        target_object[source_object[object_index]] = object_index;
+    }
+
+    AvailabilityMatrix ordered_cells;
+    ordered_cells.resize(num_total_slots, num_objects);
+    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+        hinted_cells.for_each_available(slot_index, [&](int object_index) {
+            ordered_cells.set_available(slot_index, target_object[object_index]);
+        });
+    }
+    hinted_cells = std::move(ordered_cells);
+}
+
+// The grid is built a day at a time and written without flushing every line
+void
+print_schedule_grid(const Schedule& schedule)
+{
+    size_t view_index = 0;
+    std::string day_grid;
+    for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+        if (slot_index % num_daily_slots == 0) {
+            std::cout.write(day_grid.data(), day_grid.size());
+            day_grid = "Day " + std::to_string(slot_index / num_daily_slots) + "\n";
+        }
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            if ((view_index < schedule.views.size()) and
+                (schedule.views[view_index] == std::make_pair(slot_index, object_index))) {
+                day_grid += "# ";
+                view_index++;
+            } else {
+                day_grid += ". ";
+            }
+        }
+        day_grid += '\n';
+    }
+    std::cout.write(day_grid.data(), day_grid.size());
+    std::cout.flush();
+}
+
+// Number of objects whose days requirement is met by the schedule
+int
+count_scheduled_objects(const Schedule& schedule, const std::vector<bool>& objects_type)
+{
+    std::vector<int> objects_days_num(num_objects, 0);
+    std::vector<int> last_viewed_day(num_objects, -1);
+    for (const std::pair<int, int>& view : schedule.views) {
+        int day_index = view.first / num_daily_slots;
+        if (last_viewed_day[view.second] != day_index) {
+            last_viewed_day[view.second] = day_index;
+            objects_days_num[view.second]++;
+        }
+    }
+    int num_scheduled_objects = 0;
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        num_scheduled_objects +=
+          objects_days_num[object_index] == object_days_requirement(objects_type, object_index);
+    }
+    return num_scheduled_objects;
+}
+
+// Greedy engine working on the availability matrix directly. Objects are placed one at a time,
+// the least flexible first, into the days and slots that widen the daily windows the least.
+// Objects left out are then inserted by moving one placed object out of their way
+struct HeuristicScheduler
+{
+    const AvailabilityMatrix& availability_matrix;
+    const std::vector<bool>& objects_type;
+    const std::vector<int64_t>& object_weights;
+    std::vector<int> day_shifts;
+    // Object viewed in each slot, -1 for free slots
+    std::vector<int> slot_owner;
+    std::vector<std::vector<int>> object_slots;
+
+    HeuristicScheduler(const AvailabilityMatrix& availability_matrix,
+                       const std::vector<bool>& objects_type,
+                       const std::vector<int64_t>& object_weights)
+      : availability_matrix(availability_matrix)
+      , objects_type(objects_type)
+      , object_weights(object_weights)
+      , day_shifts(progression_day_shifts())
+      , slot_owner(num_total_slots, -1)
+      , object_slots(num_objects)
+    {}
+
+    bool follows_progression(int object_index) const
+    {
+        return not objects_type[object_index] and has_geometric_progression();
+    }
+
+    // Picks the daily views of the object among the free available slots of the day, the run of
+    // them that keeps the used slots of the day the narrowest. Returns how much the used slots
+    // widen, -1 when the views don't fit into the window
+    int find_day_slots(int object_index, int day_index, std::vector<int>& slots) const
+    {
+        int num_views = object_daily_views_requirement(objects_type, object_index);
+        int first_day_slot = day_index * num_daily_slots;
+        int first_used_slot = -1;
+        int last_used_slot = -1;
+        std::vector<int> free_slots;
+        for (int slot_index = 0; slot_index < num_daily_slots; slot_index++) {
+            if (slot_owner[first_day_slot + slot_index] >= 0) {
+                first_used_slot = first_used_slot < 0 ? slot_index : first_used_slot;
+                last_used_slot = slot_index;
+            } else if (availability_matrix.is_available(first_day_slot + slot_index, object_index)) {
+                free_slots.push_back(slot_index);
+            }
+        }
+        bool check_window = num_daily_slots > daily_slots_window_size;
+        int used_width = first_used_slot < 0 ? 0 : last_used_slot - first_used_slot;
+        int best_width = std::numeric_limits<int>::max();
+        int best_begin = -1;
+        for (int begin = 0; begin + num_views <= int(free_slots.size()); begin++) {
+            int first_slot = free_slots[begin];
+            int last_slot = free_slots[begin + num_views - 1];
+            if (first_used_slot >= 0) {
+                first_slot = std::min(first_slot, first_used_slot);
+                last_slot = std::max(last_slot, last_used_slot);
+            }
+            int width = last_slot - first_slot;
+            if ((check_window and (width >= daily_slots_window_size)) or (width >= best_width)) {
+                continue;
+            }
+            best_width = width;
+            best_begin = begin;
+        }
+        if (best_begin < 0) {
+            return -1;
+        }
+        slots.clear();
+        for (int view_index = 0; view_index < num_views; view_index++) {
+            slots.push_back(first_day_slot + free_slots[best_begin + view_index]);
+        }
+        return best_width - used_width;
+    }
+
+    // Views of the cheapest placement of the object with the current owners, false when there is none
+    bool find_placement(int object_index, std::vector<int>& slots) const
+    {
+        std::vector<int> day_slots;
+        slots.clear();
+        if (follows_progression(object_index)) {
+            // Progressions have to end where the progression encoding of the model allows
+            int end_day = num_days;
+            if (progression_encoding == PREFIX_PROGRESSION_ENCODING) {
+                end_day -= prefix_excluded_days();
+            }
+            int best_cost = std::numeric_limits<int>::max();
+            std::vector<int> start_slots;
+            for (int start_day = 0; start_day + day_shifts.back() < end_day; start_day++) {
+                int cost = 0;
+                start_slots.clear();
+                for (int day_shift : day_shifts) {
+                    int day_cost = find_day_slots(object_index, start_day + day_shift, day_slots);
+                    if (day_cost < 0) {
+                        cost = -1;
+                        break;
+                    }
+                    cost += day_cost;
+                    start_slots.insert(start_slots.end(), day_slots.begin(), day_slots.end());
+                }
+                if ((cost >= 0) and (cost < best_cost)) {
+                    best_cost = cost;
+                    slots.swap(start_slots);
+                }
+            }
+            return not slots.empty();
+        }
+
+        // Any days, the cheapest ones
+        std::vector<std::pair<int, int>> day_costs;
+        for (int day_index = 0; day_index < num_days; day_index++) {
+            int day_cost = find_day_slots(object_index, day_index, day_slots);
+            if (day_cost >= 0) {
+                day_costs.push_back(std::make_pair(day_cost, day_index));
+            }
+        }
+        int days_requirement = object_days_requirement(objects_type, object_index);
+        if (int(day_costs.size()) < days_requirement) {
+            return false;
+        }
+        std::sort(day_costs.begin(), day_costs.end());
+        for (int day_number = 0; day_number < days_requirement; day_number++) {
+            find_day_slots(object_index, day_costs[day_number].second, day_slots);
+            slots.insert(slots.end(), day_slots.begin(), day_slots.end());
+        }
+        return true;
+    }
+
+    void assign(int object_index, const std::vector<int>& slots)
+    {
+        for (int slot_index : slots) {
+            slot_owner[slot_index] = object_index;
+        }
+        object_slots[object_index] = slots;
+    }
+
+    void remove(int object_index)
+    {
+        for (int slot_index : object_slots[object_index]) {
+            slot_owner[slot_index] = -1;
+        }
+        object_slots[object_index].clear();
+    }
+
+    bool place(int object_index)
+    {
+        std::vector<int> slots;
+        if (not find_placement(object_index, slots)) {
+            return false;
+        }
+        assign(object_index, slots);
+        return true;
+    }
+
+    // Moves one of the objects that hold available slots of the object elsewhere to make room.
+    // A blocker that can't be moved is dropped instead when the object outweighs it
+    bool insert_by_moving(int object_index, bool allow_dropping)
+    {
+        std::vector<std::pair<int, int>> blockers;
+        std::vector<int> blocked_slots(num_objects, 0);
+        for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+            int owner = slot_owner[slot_index];
+            if ((owner >= 0) and availability_matrix.is_available(slot_index, object_index)) {
+                blocked_slots[owner]++;
+            }
+        }
+        for (int blocker_index = 0; blocker_index < num_objects; blocker_index++) {
+            if (blocked_slots[blocker_index] > 0) {
+                blockers.push_back(std::make_pair(-blocked_slots[blocker_index], blocker_index));
+            }
+        }
+        std::sort(blockers.begin(), blockers.end());
+        if (int(blockers.size()) > max_heuristic_blockers) {
+            blockers.resize(max_heuristic_blockers);
+        }
+
+        std::vector<int> blocker_slots;
+        for (const std::pair<int, int>& blocker : blockers) {
+            int blocker_index = blocker.second;
+            blocker_slots = object_slots[blocker_index];
+            remove(blocker_index);
+            if (place(object_index)) {
+                if (place(blocker_index) or
+                    (allow_dropping and (object_weights[object_index] > object_weights[blocker_index]))) {
+                    return true;
+                }
+                remove(object_index);
+            }
+            assign(blocker_index, blocker_slots);
+        }
+        return false;
+    }
+
+    // Number of the available cells of the object, the fewer the earlier it is placed
+    std::vector<int> count_object_cells() const
+    {
+        std::vector<int> num_cells(num_objects, 0);
+        for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+            availability_matrix.for_each_available(slot_index, [&](int object_index) {
+                num_cells[object_index]++;
+            });
+        }
+        return num_cells;
+    }
+
+    void run(bool allow_dropping)
+    {
+        std::vector<int> num_cells = count_object_cells();
+        std::vector<int> order(num_objects);
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            order[object_index] = object_index;
+        }
+        // Heavier objects first, then progressions, then by the spare cells
+        std::stable_sort(order.begin(), order.end(), [&](int first, int second) {
+            if (object_weights[first] != object_weights[second]) {
+                return object_weights[first] > object_weights[second];
+            }
+            if (follows_progression(first) != follows_progression(second)) {
+                return follows_progression(first);
+            }
+            return num_cells[first] < num_cells[second];
+        });
+        for (int object_index : order) {
+            place(object_index);
+        }
+
+        for (int round = 0; round < heuristic_repair_rounds; round++) {
+            bool is_improved = false;
+            for (int object_index : order) {
+                if (object_slots[object_index].empty() and
+                    (place(object_index) or insert_by_moving(object_index, allow_dropping))) {
+                    is_improved = true;
+                }
+            }
+            if (not is_improved) {
+                break;
+            }
+        }
+    }
+
+    Schedule schedule() const
+    {
+        Schedule result;
+        for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
+            if (slot_owner[slot_index] >= 0) {
+                result.views.push_back(std::make_pair(slot_index, slot_owner[slot_index]));
+            }
+        }
+        return result;
+    }
+};
+
+// Runs the heuristic engine, returns the number of scheduled objects
+int
+generate_heuristic_schedule(const AvailabilityMatrix& availability_matrix,
+                            const std::vector<bool>& objects_type,
+                            const std::vector<int64_t>& object_weights,
+                            Schedule& solution)
+{
+    HeuristicScheduler scheduler(availability_matrix, objects_type, object_weights);
+    scheduler.run(best_effort);
+    solution = scheduler.schedule();
+    int num_scheduled_objects = 0;
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        num_scheduled_objects += not scheduler.object_slots[object_index].empty();
+    }
+    return num_scheduled_objects;
+}
+
+// Rolling horizon: solves windows of rolling_window_days days one after another and
+// commits the first rolling_window_days - rolling_overlap_days days of each window.
+// Committed days of type A objects and started type B progressions are carried forward.
+// Window models maximize the viewed object days, so they always have a solution,
+// objects that can't be completed are removed from the schedule at the end
+bool
+generate_rolling_schedule(const AvailabilityMatrix& availability_matrix,
+                          const std::vector<bool>& objects_type,
+                          PresolveResult& presolve_result,
+                          Schedule& schedule)
+{
+    int step_days = rolling_window_days - rolling_overlap_days;
+    int num_windows = (std::max(0, num_days - rolling_window_days) + step_days - 1) / step_days + 1;
+    std::vector<int> day_shifts = progression_day_shifts();
+    bool use_progression = has_geometric_progression();
+
+    std::vector<int> completed_days(num_objects, 0);
+    std::vector<int> progression_start(num_objects, -1);
+    std::vector<uint8_t> is_object_dropped(num_objects, 0);
+    std::vector<uint8_t> is_object_fixed(num_objects, 0);
+    std::vector<uint8_t> is_day_usable(presolve_result.is_day_usable);
+    int64_t max_window_variables = 0;
+    int64_t max_window_constraints = 0;
+
+    SatParameters parameters = make_solver_parameters();
+    if (time_limit_seconds > 0) {
+        double window_time_limit = time_limit_seconds / num_windows;
+        if (parameters.interleave_search()) {
+            parameters.set_max_deterministic_time(window_time_limit);
+        } else {
+            parameters.set_max_time_in_seconds(window_time_limit);
+        }
+    }
+
+    for (int first_day = 0; first_day < num_days; first_day += step_days) {
+        int last_day = std::min(num_days, first_day + rolling_window_days);
+        int commit_day = (last_day == num_days) ? num_days : first_day + step_days;
+
+        // Days the carried state rules out
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            bool is_done = is_object_dropped[object_index] or
+              (completed_days[object_index] == object_days_requirement(objects_type, object_index));
+            for (int day_index = first_day; day_index < last_day; day_index++) {
+                if (is_done) {
+                    is_day_usable[day_index * num_objects + object_index] = 0;
+                }
+            }
+        }
+
+        ProtoModelBuilder model;
+        DayRangeModel range;
+        range.first_day = first_day;
+        range.last_day = last_day;
+        pipeline_stats.start_phase();
+        add_day_range_constraints(model, availability_matrix, objects_type, is_day_usable,
+                                  nullptr, is_object_fixed, nullptr, build_threads, presolve_result,
+                                  range);
+
+        for (int object_index = 0; object_index < num_objects; object_index++) {
+            bool is_progression = use_progression and not objects_type[object_index];
+            if (not is_progression) {
+                ConstraintProto* window_object_days =
+                  model.add_linear(0, object_days_requirement(objects_type, object_index) -
+                                        completed_days[object_index]);
+                for (int day_index = first_day; day_index < last_day; day_index++) {
+                    model.add_term(window_object_days, range.day(day_index, object_index), 1);
+                    model.add_maximized_term(range.day(day_index, object_index), 1);
+                }
+                continue;
+            }
+            if (progression_start[object_index] >= 0) {
+                // Progression in flight: all its days in the window or the object is dropped
+                int keep_progression = model.new_bool_var();
+                for (int day_index = first_day; day_index < last_day; day_index++) {
+                    int day_shift = day_index - progression_start[object_index];
+                    if (std::find(day_shifts.begin(), day_shifts.end(), day_shift) != day_shifts.end()) {
+                        ConstraintProto* keep = model.add_linear(0, 0);
+                        model.add_term(keep, range.day(day_index, object_index), 1);
+                        model.add_term(keep, keep_progression, -1);
+                    } else if (is_day_usable[day_index * num_objects + object_index]) {
+                        ConstraintProto* skip = model.add_linear(0, 0);
+                        model.add_term(skip, range.day(day_index, object_index), 1);
+                    }
+                }
+                // Outweighs everything one window can gain by dropping it
+                model.add_maximized_term(keep_progression, num_objects * rolling_window_days);
+                continue;
+            }
+            // Not started yet: choose at most one start day in the window
+            ConstraintProto* start_days = model.add_at_most_one();
+            std::vector<std::vector<int>> window_day_starts(last_day - first_day);
+            for (int start_day = first_day; start_day < last_day; start_day++) {
+                if (start_day + day_shifts.back() >= num_days) {
+                    break;
+                }
+                bool is_start_usable = true;
+                for (int day_shift : day_shifts) {
+                    is_start_usable = is_start_usable and
+                      presolve_result.is_day_usable[(start_day + day_shift) * num_objects + object_index];
+                }
+                if (not is_start_usable) {
+                    continue;
+                }
+                int start_literal = model.new_bool_var();
+                model.add_literal(start_days->mutable_at_most_one(), start_literal);
+                for (int day_shift : day_shifts) {
+                    if (start_day + day_shift < last_day) {
+                        window_day_starts[start_day + day_shift - first_day].push_back(start_literal);
+                    }
+                }
+            }
+            // The day is viewed when one of the starts covering it is chosen
+            for (int day_index = first_day; day_index < last_day; day_index++) {
+                if (not is_day_usable[day_index * num_objects + object_index]) {
                     continue;
                 }
-                current_progression_element = 1;
-                current_day_shift = 0;
-                for (int progression_index = 0; progression_index < days_requirement_type_b - 1; progression_index++){
-                    current_day_shift += current_progression_element;
-                    
-                    // w_{i+shift} + prefix sum_{i} >= w_{i}
-                    cp_model.AddGreaterOrEqual(
-                        is_object_viewed_in_day[(day_index + current_day_shift) * num_objects + object_index]
-                        + object_days_prexif_sum[day_index * num_objects + object_index],
-                        is_object_viewed_in_day[day_index * num_objects + object_index]
-                    );
-                    
-                    current_progression_element *= progression_ratio;
+                ConstraintProto* covered = model.add_exactly_one();
+                model.add_literal(covered->mutable_exactly_one(),
+                                  ProtoModelBuilder::negated(range.day(day_index, object_index)));
+                for (int start_literal : window_day_starts[day_index - first_day]) {
+                    model.add_literal(covered->mutable_exactly_one(), start_literal);
                 }
+                model.add_maximized_term(range.day(day_index, object_index), 1);
             }
         }
 
-        // Сan not use the last few days as the beginning of a sequence
-        for (int day_index = num_days - max_day_shift; day_index < num_days; day_index++){
+        const CpModelProto& model_proto = model.proto;
+        max_window_variables = std::max<int64_t>(max_window_variables, model_proto.variables_size());
+        max_window_constraints = std::max<int64_t>(max_window_constraints, model_proto.constraints_size());
+        pipeline_stats.end_phase("rolling_build");
+        const CpSolverResponse response = SolveWithParameters(model_proto, parameters);
+        pipeline_stats.end_phase("rolling_solve");
+        if (response.status() != CpSolverStatus::OPTIMAL and
+            response.status() != CpSolverStatus::FEASIBLE) {
+            LOG(INFO) << "Window " << first_day << "-" << last_day - 1
+                      << ": no solution found, its days stay empty";
+            continue;
+        }
+
+        // Commit the first days of the window
+        Schedule committed = extract_schedule(response, range, commit_day);
+        schedule.views.insert(schedule.views.end(), committed.views.begin(), committed.views.end());
+        for (int day_index = first_day; day_index < commit_day; day_index++) {
             for (int object_index = 0; object_index < num_objects; object_index++) {
-                if (objects_type[object_index]) {
+                if (not is_day_usable[day_index * num_objects + object_index]) {
                     continue;
                 }
-                // Realy bad realization, but will work
-                cp_model.AddEquality(is_object_viewed_in_day[day_index * num_objects + object_index], 0);
+                if (literal_value(response, range.day(day_index, object_index))) {
+                    if (completed_days[object_index]++ == 0 and not objects_type[object_index]) {
+                        progression_start[object_index] = day_index;
+                    }
+                } else if (progression_start[object_index] >= 0 and
+                           std::find(day_shifts.begin(), day_shifts.end(),
+                                     day_index - progression_start[object_index]) != day_shifts.end()) {
+                    is_object_dropped[object_index] = 1;
+                }
+            }
+        }
+        LOG(INFO) << "Window " << first_day << "-" << last_day - 1 << ": "
+                  << model_proto.variables_size() << " variables, "
+                  << model_proto.constraints_size() << " constraints, objective "
+                  << response.objective_value() << ", solve time " << response.wall_time() << " s";
+        if (last_day == num_days) {
+            break;
+        }
+    }
+
+    // Objects that weren't completed are removed, the schedule stays valid
+    std::vector<uint8_t> is_object_complete(num_objects, 0);
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        is_object_complete[object_index] = not is_object_dropped[object_index] and
+          (completed_days[object_index] == object_days_requirement(objects_type, object_index));
+    }
+    schedule.views.erase(std::remove_if(schedule.views.begin(), schedule.views.end(),
+                                        [&](const std::pair<int, int>& view) {
+                                            return not is_object_complete[view.second];
+                                        }),
+                         schedule.views.end());
+    LOG(INFO) << "Rolling horizon: " << num_windows << " windows of " << rolling_window_days
+              << " days with " << rolling_overlap_days << " days overlap, largest window model "
+              << max_window_variables << " variables, " << max_window_constraints << " constraints";
+    return true;
+}
+
+// --compare_monolithic: solves the whole horizon as one best-effort model, so it is compared with
+// the rolling result by the number of scheduled objects. presolve_result is the presolve before
+// the unschedulable objects were left out
+void
+compare_with_monolithic(const AvailabilityMatrix& availability_matrix,
+                        const std::vector<bool>& objects_type,
+                        const PresolveResult& presolve_result,
+                        int num_rolling_scheduled,
+                        double rolling_seconds)
+{
+    auto monolithic_start = std::chrono::steady_clock::now();
+    ProtoModelBuilder model;
+    DayRangeModel range;
+    PresolveResult monolithic_presolve = presolve_result;
+    std::vector<uint8_t> is_object_fixed(num_objects, 0);
+    std::vector<int64_t> object_weights(num_objects, 1);
+    build_monolithic_model(model, availability_matrix, objects_type, nullptr, is_object_fixed,
+                           nullptr, &object_weights, nullptr, &pipeline_stats, build_threads,
+                           monolithic_presolve, range);
+    const CpSolverResponse response = SolveWithParameters(model.proto, make_solver_parameters());
+    std::chrono::duration<double> monolithic_time = std::chrono::steady_clock::now() - monolithic_start;
+    pipeline_stats.end_phase("monolithic");
+
+    LOG(INFO) << "Rolling horizon: " << num_rolling_scheduled << " of " << num_objects
+              << " objects in " << rolling_seconds << " s";
+    if (response.status() != CpSolverStatus::OPTIMAL and response.status() != CpSolverStatus::FEASIBLE) {
+        LOG(INFO) << "Monolithic: no schedule in " << monolithic_time.count() << " s, status "
+                  << CpSolverStatus_Name(response.status());
+        return;
+    }
+    Schedule monolithic_solution = extract_schedule(response, range, num_days);
+    int num_monolithic_scheduled = count_scheduled_objects(monolithic_solution, objects_type);
+    LOG(INFO) << "Monolithic: " << num_monolithic_scheduled << " of " << num_objects
+              << " objects in " << monolithic_time.count() << " s, status "
+              << CpSolverStatus_Name(response.status()) << ", bound " << response.best_objective_bound();
+    LOG(INFO) << "Gap: " << num_monolithic_scheduled - num_rolling_scheduled << " objects";
+}
+
+// Objects compete only for the slots and the window of days they can both be watched on.
+// Objects of different components never share a usable day, so they can be scheduled apart
+struct ObjectComponents
+{
+    // Objects of every component in increasing order, components ordered by their first object
+    std::vector<std::vector<int>> objects;
+    std::vector<int> num_component_cells;
+};
+
+int
+find_component_root(std::vector<int>& parent, int object_index)
+{
+    while (parent[object_index] != object_index) {
+        parent[object_index] = parent[parent[object_index]];
+        object_index = parent[object_index];
+    }
+    return object_index;
+}
+
+void
+find_object_components(const AvailabilityMatrix& availability_matrix,
+                       const std::vector<uint8_t>& is_day_usable,
+                       ObjectComponents& components)
+{
+    std::vector<int> parent(num_objects);
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        parent[object_index] = object_index;
+    }
+    std::vector<int> object_cells(num_objects, 0);
+    for (int day_index = 0; day_index < num_days; day_index++) {
+        // Every object watchable on the day is joined with the first one
+        int day_root = -1;
+        for (int slot_index = day_index * num_daily_slots; slot_index < (day_index + 1) * num_daily_slots;
+             slot_index++) {
+            availability_matrix.for_each_available(slot_index, [&](int object_index) {
+                if (not is_day_usable[day_index * num_objects + object_index]) {
+                    return;
+                }
+                object_cells[object_index]++;
+                int object_root = find_component_root(parent, object_index);
+                if (day_root == -1) {
+                    day_root = object_root;
+                } else if (object_root != day_root) {
+                    parent[std::max(object_root, day_root)] = std::min(object_root, day_root);
+                    day_root = std::min(object_root, day_root);
+                }
+            });
+        }
+    }
+
+    std::vector<int> component_index(num_objects, -1);
+    components.objects.clear();
+    components.num_component_cells.clear();
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        int root = find_component_root(parent, object_index);
+        if (component_index[root] == -1) {
+            component_index[root] = components.objects.size();
+            components.objects.emplace_back();
+            components.num_component_cells.push_back(0);
+        }
+        components.objects[component_index[root]].push_back(object_index);
+        components.num_component_cells[component_index[root]] += object_cells[object_index];
+    }
+}
+
+struct ComponentResult
+{
+    CpSolverStatus status = CpSolverStatus::UNKNOWN;
+    Schedule schedule;
+    int64_t variables = 0;
+    int64_t constraints = 0;
+    int64_t terms = 0;
+    double wall_time = 0;
+    // Constraint families of the component model
+    PipelineStats build_stats;
+};
+
+// Latest solutions of the components while they are solved. With --stream the merged
+// schedule is written whenever a component improves and every component has a solution,
+// best-effort schedules may leave components out. Best-effort solves report the sums of the
+// component objectives and bounds, a component without a solution is bounded by its weight
+struct ComponentProgress
+{
+    std::mutex mutex;
+    std::vector<Schedule> schedules;
+    std::vector<uint8_t> has_solution;
+    std::vector<double> objectives;
+    std::vector<double> bounds;
+    int num_components_with_solution = 0;
+    int num_streamed_solutions = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    ComponentProgress(const ObjectComponents& components, const std::vector<int64_t>* object_weights)
+      : schedules(components.objects.size())
+      , has_solution(components.objects.size(), 0)
+      , objectives(components.objects.size(), 0)
+      , bounds(components.objects.size(), 0)
+    {
+        for (size_t component_index = 0; component_index < components.objects.size(); component_index++) {
+            for (int object_index : components.objects[component_index]) {
+                bounds[component_index] += object_weights == nullptr ? 1 : (*object_weights)[object_index];
+            }
+        }
+    }
+
+    void update(int component_index, const CpSolverResponse& response, const DayRangeModel& range)
+    {
+        Schedule component_schedule = extract_schedule(response, range, num_days);
+        std::lock_guard<std::mutex> lock(mutex);
+        schedules[component_index] = std::move(component_schedule);
+        if (not has_solution[component_index]) {
+            has_solution[component_index] = 1;
+            num_components_with_solution++;
+        }
+        if (best_effort) {
+            objectives[component_index] = response.objective_value();
+            bounds[component_index] = response.best_objective_bound();
+            double objective = 0;
+            double bound = 0;
+            for (size_t index = 0; index < objectives.size(); index++) {
+                objective += objectives[index];
+                bound += bounds[index];
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            pipeline_stats.progress.push_back({elapsed.count(), objective, bound});
+            LOG(INFO) << "Objective " << objective << ", bound " << bound << " at " << elapsed.count()
+                      << " s, component " << component_index;
+        }
+        if (stream_solutions and
+            (best_effort or (num_components_with_solution == int(schedules.size())))) {
+            Schedule merged_schedule;
+            for (const Schedule& schedule : schedules) {
+                merged_schedule.views.insert(merged_schedule.views.end(), schedule.views.begin(),
+                                             schedule.views.end());
+            }
+            merged_schedule.sort();
+            if (save_schedule_to_file(output_filename, merged_schedule)) {
+                num_streamed_solutions++;
+                LOG(INFO) << "Solution " << num_streamed_solutions << " written to " << output_filename
+                          << " after an improvement of component " << component_index;
+            }
+        }
+    }
+};
+
+// Builds and solves one model per component on component_threads threads,
+// largest components first, then stitches the schedules together
+bool
+solve_components(const AvailabilityMatrix& availability_matrix,
+                 const std::vector<bool>& objects_type,
+                 const PresolveResult& presolve_result,
+                 const AvailabilityMatrix* hinted_cells,
+                 const std::vector<uint8_t>& is_object_fixed,
+                 const std::vector<std::vector<int>>& identical_objects,
+                 const std::vector<int64_t>* object_weights,
+                 const ObjectComponents& components,
+                 Schedule& schedule,
+                 CpSolverStatus& status)
+{
+    int num_components = components.objects.size();
+    std::vector<int> components_order(num_components);
+    for (int component_index = 0; component_index < num_components; component_index++) {
+        components_order[component_index] = component_index;
+    }
+    std::stable_sort(components_order.begin(), components_order.end(), [&](int left, int right) {
+        return components.num_component_cells[left] > components.num_component_cells[right];
+    });
+
+    // Cores are split between the components solved at once, for building as for solving
+    int num_threads = std::max(1, std::min(component_threads, num_components));
+    SatParameters parameters = make_solver_parameters();
+    parameters.set_num_workers(std::max(1, parameters.num_workers() / num_threads));
+    int component_build_threads = std::max(1, build_threads / num_threads);
+
+    // --time_limit bounds the whole decomposed solve. A component gets the time left before the
+    // deadline divided by the rounds of components still waiting for a thread, deterministic
+    // time can't be measured against a deadline, so it is split evenly between the rounds
+    bool use_deadline = (time_limit_seconds > 0) and not parameters.interleave_search();
+    std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(time_limit_seconds));
+    if ((time_limit_seconds > 0) and parameters.interleave_search()) {
+        int num_rounds = (num_components + num_threads - 1) / num_threads;
+        parameters.set_max_deterministic_time(time_limit_seconds / num_rounds);
+    }
+
+    std::vector<ComponentResult> results(num_components);
+    ComponentProgress progress(components, object_weights);
+    std::atomic<int> next_component(0);
+    auto solve_next_components = [&]() {
+        for (int order_index = next_component++; order_index < num_components;
+             order_index = next_component++) {
+            int component_index = components_order[order_index];
+            std::vector<uint8_t> is_object_in_model(num_objects, 0);
+            for (int object_index : components.objects[component_index]) {
+                is_object_in_model[object_index] = 1;
+            }
+            PresolveResult component_presolve;
+            component_presolve.is_day_usable = presolve_result.is_day_usable;
+            for (int day_index = 0; day_index < num_days; day_index++) {
+                for (int object_index = 0; object_index < num_objects; object_index++) {
+                    component_presolve.is_day_usable[day_index * num_objects + object_index] &=
+                      is_object_in_model[object_index];
+                }
+            }
+
+            ComponentResult& result = results[component_index];
+            if (use_deadline and (std::chrono::steady_clock::now() >= deadline)) {
+                continue;
+            }
+            result.build_stats.start_phase();
+            ProtoModelBuilder model;
+            DayRangeModel range;
+            build_monolithic_model(model, availability_matrix, objects_type, hinted_cells,
+                                   is_object_fixed, &is_object_in_model, object_weights, nullptr,
+                                   &result.build_stats, component_build_threads, component_presolve,
+                                   range);
+            add_symmetry_breaking(model, range, identical_objects, &is_object_in_model);
+            result.build_stats.end_model_phase("symmetry_breaking", model.proto);
+            SatParameters component_parameters = parameters;
+            if (use_deadline) {
+                int num_rounds = (num_components - order_index + num_threads - 1) / num_threads;
+                std::chrono::duration<double> time_left = deadline - std::chrono::steady_clock::now();
+                component_parameters.set_max_time_in_seconds(std::max(0.0, time_left.count() / num_rounds));
+            }
+            Model solver_model;
+            solver_model.Add(NewSatParameters(component_parameters));
+            if (stream_solutions or best_effort) {
+                solver_model.Add(NewFeasibleSolutionObserver([&](const CpSolverResponse& partial_response) {
+                    progress.update(component_index, partial_response, range);
+                }));
+            }
+            const CpSolverResponse response = SolveCpModel(model.proto, &solver_model);
+
+            result.status = response.status();
+            result.variables = model.proto.variables_size();
+            result.constraints = model.proto.constraints_size();
+            result.terms = count_model_terms(model.proto);
+            result.wall_time = response.wall_time();
+            if (result.status == CpSolverStatus::OPTIMAL or result.status == CpSolverStatus::FEASIBLE) {
+                result.schedule = extract_schedule(response, range, num_days);
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int thread_index = 1; thread_index < num_threads; thread_index++) {
+        threads.emplace_back(solve_next_components);
+    }
+    solve_next_components();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Families are summed over the components, seconds too although components are built in parallel
+    std::vector<PhaseStats> family_phases;
+    for (const ComponentResult& result : results) {
+        for (const PhaseStats& phase : result.build_stats.phases) {
+            size_t family_index = 0;
+            while ((family_index < family_phases.size()) and (family_phases[family_index].name != phase.name)) {
+                family_index++;
+            }
+            if (family_index == family_phases.size()) {
+                family_phases.push_back(phase);
+                continue;
+            }
+            PhaseStats& family = family_phases[family_index];
+            family.seconds += phase.seconds;
+            family.variables += phase.variables;
+            family.constraints += phase.constraints;
+            family.terms += phase.terms;
+            family.peak_rss_kb = std::max(family.peak_rss_kb, phase.peak_rss_kb);
+        }
+    }
+    pipeline_stats.phases.insert(pipeline_stats.phases.end(), family_phases.begin(), family_phases.end());
+
+    // Infeasible if one component is, unknown if one reached the limit. Best-effort schedules
+    // keep the solved components and leave out the objects of the timed out ones
+    status = CpSolverStatus::OPTIMAL;
+    int num_timed_out_components = 0;
+    for (int component_index = 0; component_index < num_components; component_index++) {
+        const ComponentResult& result = results[component_index];
+        pipeline_stats.model_variables += result.variables;
+        pipeline_stats.model_constraints += result.constraints;
+        pipeline_stats.model_terms += result.terms;
+        if (result.status == CpSolverStatus::INFEASIBLE or result.status == CpSolverStatus::MODEL_INVALID) {
+            LOG(INFO) << "Component " << component_index << " of " << components.objects[component_index].size()
+                      << " objects starting with object " << components.objects[component_index][0]
+                      << ": " << CpSolverStatus_Name(result.status);
+            status = result.status;
+        } else if (result.status == CpSolverStatus::UNKNOWN) {
+            LOG(INFO) << "Component " << component_index << " of " << components.objects[component_index].size()
+                      << " objects starting with object " << components.objects[component_index][0]
+                      << ": no solution before the time limit"
+                      << (best_effort ? ", its objects are left out" : "");
+            num_timed_out_components++;
+            if (best_effort and status == CpSolverStatus::OPTIMAL) {
+                status = CpSolverStatus::FEASIBLE;
+            } else if (not best_effort and status != CpSolverStatus::INFEASIBLE and
+                       status != CpSolverStatus::MODEL_INVALID) {
+                status = CpSolverStatus::UNKNOWN;
             }
+        } else if (result.status == CpSolverStatus::FEASIBLE and status == CpSolverStatus::OPTIMAL) {
+            status = CpSolverStatus::FEASIBLE;
+        }
+        schedule.views.insert(schedule.views.end(), result.schedule.views.begin(), result.schedule.views.end());
+    }
+    schedule.sort();
+    if (best_effort and (num_timed_out_components == num_components)) {
+        status = CpSolverStatus::UNKNOWN;
+    }
+
+    double max_wall_time = 0;
+    for (const ComponentResult& result : results) {
+        max_wall_time = std::max(max_wall_time, result.wall_time);
+    }
+    LOG(INFO) << "Solved " << num_components << " components on " << num_threads << " threads, "
+              << "largest has " << components.objects[components_order[0]].size() << " objects, "
+              << "longest solve " << max_wall_time << " s";
+    if (num_timed_out_components > 0) {
+        LOG(INFO) << num_timed_out_components << " of " << num_components
+                  << " components have no solution before the time limit";
+    }
+    return status == CpSolverStatus::OPTIMAL or status == CpSolverStatus::FEASIBLE;
+}
+
+// Requirements of every object, and with diagnose_days the window of every day, are guarded by
+// assumption literals. An infeasible solve returns a small set of assumptions that can't hold
+// together, it is logged and written to core_filename
+bool
+diagnose_infeasibility(const AvailabilityMatrix& availability_matrix,
+                       const std::vector<bool>& objects_type,
+                       PresolveResult& presolve_result)
+{
+    ProtoModelBuilder model;
+    DayRangeModel range;
+    if (diagnose_days) {
+        range.day_window_literal.resize(num_days);
+        for (int day_index = 0; day_index < num_days; day_index++) {
+            range.day_window_literal[day_index] = model.new_bool_var();
+        }
+    }
+    std::vector<int> object_literals;
+    std::vector<uint8_t> is_object_fixed(num_objects, 0);
+    build_monolithic_model(model, availability_matrix, objects_type, nullptr, is_object_fixed, nullptr,
+                           nullptr, &object_literals, &pipeline_stats, build_threads, presolve_result,
+                           range);
+
+    // Assumption literal -> object or day
+    std::vector<std::pair<std::string, int>> assumption_sources(model.proto.variables_size());
+    for (int object_index = 0; object_index < num_objects; object_index++) {
+        model.proto.add_assumptions(object_literals[object_index]);
+        assumption_sources[object_literals[object_index]] = std::make_pair("object", object_index);
+    }
+    for (int day_index = 0; day_index < int(range.day_window_literal.size()); day_index++) {
+        model.proto.add_assumptions(range.day_window_literal[day_index]);
+        assumption_sources[range.day_window_literal[day_index]] = std::make_pair("day", day_index);
+    }
+    pipeline_stats.end_phase("build");
+    pipeline_stats.model_variables = model.proto.variables_size();
+    pipeline_stats.model_constraints = model.proto.constraints_size();
+    pipeline_stats.model_terms = count_model_terms(model.proto);
+
+    // Cores are only extracted by the single worker search
+    SatParameters parameters = make_solver_parameters();
+    parameters.set_num_workers(1);
+    const CpSolverResponse response = SolveWithParameters(model.proto, parameters);
+    pipeline_stats.end_phase("solve");
+
+    if (response.status() != CpSolverStatus::INFEASIBLE) {
+        LOG(INFO) << (response.status() == CpSolverStatus::UNKNOWN
+                        ? "Feasibility isn't decided before the search limit, no core found."
+                        : "The model is feasible, there is nothing to diagnose.");
+        report_pipeline_stats(CpSolverStatus_Name(response.status()));
+        return true;
+    }
+
+    std::ostringstream core;
+    core << "# " << response.sufficient_assumptions_for_infeasibility_size()
+         << " requirements that can't be met together\n";
+    for (int literal : response.sufficient_assumptions_for_infeasibility()) {
+        const std::pair<std::string, int>& source = assumption_sources[literal];
+        if (source.first == "object") {
+            LOG(INFO) << "Core: object " << source.second << " (type "
+                      << (objects_type[source.second] ? "A" : "B") << ", "
+                      << object_days_requirement(objects_type, source.second) << " days, "
+                      << object_daily_views_requirement(objects_type, source.second) << " views a day)";
+        } else {
+            LOG(INFO) << "Core: window of day " << source.second;
+        }
+        core << source.first << "," << source.second << "\n";
+    }
+    LOG(INFO) << "Infeasible, the core has " << response.sufficient_assumptions_for_infeasibility_size()
+              << " of " << model.proto.assumptions_size() << " requirements.";
+    if (not core_filename.empty()) {
+        std::ofstream file(core_filename, std::ios::trunc);
+        file << core.str();
+        if (not file.good()) {
+            std::cerr << "Can't write file " << core_filename << std::endl;
+            return false;
         }
     }
+    report_pipeline_stats("INFEASIBLE");
+    return true;
+}
+
+// Model cache file, native byte order: ModelCacheHeader, the slot_begin, cell_object,
+// cell_literal and day_literal arrays of the DayRangeModel as 32-bit integers, then the
+// serialized CpModelProto. Files are named by the key, the key is repeated in the header
+const char MODEL_CACHE_MAGIC[8] = {'S', 'A', 'T', 'M', 'O', 'D', 'E', 'L'};
+const uint32_t MODEL_CACHE_VERSION = 2;
+
+struct ModelCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    int32_t first_day;
+    int32_t last_day;
+    uint32_t reserved;
+    uint64_t key;
+    uint64_t num_slot_begin;
+    uint64_t num_cells;
+    uint64_t num_day_literals;
+    uint64_t num_matrix_words;
+    uint64_t num_types;
+    uint64_t model_size;
+};
+
+// FNV-1a
+uint64_t
+hash_bytes(uint64_t hash, const char* data, size_t size)
+{
+    for (size_t index = 0; index < size; index++) {
+        hash = (hash ^ uint8_t(data[index])) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool
+hash_file(uint64_t& hash, const std::string& filename)
+{
+    MappedFile file;
+    if (not file.open(filename)) {
+        std::cerr << "Can't open file " << filename << std::endl;
+        return false;
+    }
+    hash = hash_bytes(hash, file.data, file.size);
+    return true;
+}
+
+// Contents of every input file and every parameter the model depends on
+bool
+model_cache_key(uint64_t& key)
+{
+    std::ostringstream parameters;
+    parameters << MODEL_CACHE_VERSION << " " << num_days << " " << num_daily_slots << " " << num_objects
+               << " " << days_requirement_type_a << " " << days_requirement_type_b << " "
+               << daily_views_requirement_type_a << " " << daily_views_requirement_type_b << " "
+               << progression_ratio << " " << daily_slots_window_size << " " << window_encoding << " "
+               << progression_encoding << " " << use_presolve << " " << use_symmetry_breaking << " "
+               << use_decomposition << " " << use_precheck << " " << best_effort << " " << engine << " " << heuristic_repair_rounds << " "
+               << max_heuristic_blockers << " " << hint_mode << " " << first_allowed_day << " "
+               << last_allowed_day;
+    for (const std::pair<int, int>& slot_range : blocked_slots) {
+        parameters << " " << slot_range.first << "-" << slot_range.second;
+    }
+    std::string parameters_text = parameters.str();
+    key = hash_bytes(14695981039346656037ull, parameters_text.data(), parameters_text.size());
+    if (not hash_file(key, availability_matrix_filename) or not hash_file(key, objects_type_filename)) {
+        return false;
+    }
+    if (best_effort and not weights_filename.empty() and not hash_file(key, weights_filename)) {
+        return false;
+    }
+    if (not hint_filename.empty() and not hash_file(key, hint_filename)) {
+        return false;
+    }
+    return true;
+}
+
+std::string
+model_cache_filename(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.model", static_cast<unsigned long long>(key));
+    return model_cache_directory + "/" + name;
+}
+
+void
+write_cache_array(std::ofstream& file, const std::vector<int>& values)
+{
+    std::vector<int32_t> stored(values.begin(), values.end());
+    file.write(reinterpret_cast<const char*>(stored.data()), stored.size() * sizeof(int32_t));
+}
+
+void
+read_cache_array(const char*& data, size_t size, std::vector<int>& values)
+{
+    const int32_t* stored = reinterpret_cast<const int32_t*>(data);
+    values.assign(stored, stored + size);
+    data += size * sizeof(int32_t);
+}
+
+// Writes key.model.tmp and renames it, so concurrent runs never read a partial file
+bool
+save_model_cache(uint64_t key,
+                 const CpModelProto& model_proto,
+                 const DayRangeModel& range,
+                 const AvailabilityMatrix& availability_matrix,
+                 const std::vector<bool>& objects_type)
+{
+    std::string filename = model_cache_filename(key);
+    std::string temporary_filename = filename + ".tmp";
+    std::string model_bytes;
+    if (not model_proto.SerializeToString(&model_bytes)) {
+        std::cerr << "Can't serialize the model for the cache" << std::endl;
+        return false;
+    }
+    std::ofstream file(temporary_filename, std::ios::binary | std::ios::trunc);
+    if (not file.is_open()) {
+        std::cerr << "Can't open file " << temporary_filename << std::endl;
+        return false;
+    }
+    ModelCacheHeader header = {};
+    std::copy(MODEL_CACHE_MAGIC, MODEL_CACHE_MAGIC + sizeof(MODEL_CACHE_MAGIC), header.magic);
+    header.version = MODEL_CACHE_VERSION;
+    header.first_day = range.first_day;
+    header.last_day = range.last_day;
+    header.key = key;
+    header.num_slot_begin = range.slot_begin.size();
+    header.num_cells = range.cell_literal.size();
+    header.num_day_literals = range.day_literal.size();
+    header.num_matrix_words = size_t(availability_matrix.num_slots) * availability_matrix.words_per_slot;
+    header.num_types = objects_type.size();
+    header.model_size = model_bytes.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(availability_matrix.words),
+               header.num_matrix_words * sizeof(uint64_t));
+    write_cache_array(file, range.slot_begin);
+    write_cache_array(file, range.cell_object);
+    write_cache_array(file, range.cell_literal);
+    write_cache_array(file, range.day_literal);
+    write_cache_array(file, std::vector<int>(objects_type.begin(), objects_type.end()));
+    file.write(model_bytes.data(), model_bytes.size());
+    file.close();
+    if (not file.good()) {
+        std::cerr << "Can't write file " << temporary_filename << std::endl;
+        return false;
+    }
+    if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Can't replace file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// False when there is no cached model for the key or the file doesn't match it.
+// The key covers the input files, so the stored matrix (with the blackouts applied)
+// and object types validate the schedule without reading the inputs again
+bool
+load_model_cache(uint64_t key,
+                 CpModelProto& model_proto,
+                 DayRangeModel& range,
+                 AvailabilityMatrix& availability_matrix,
+                 std::vector<bool>& objects_type)
+{
+    std::string filename = model_cache_filename(key);
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    if (not file->open(filename)) {
+        return false;
+    }
+    if (file->size < sizeof(ModelCacheHeader)) {
+        return false;
+    }
+    ModelCacheHeader header;
+    std::copy(file->data, file->data + sizeof(header), reinterpret_cast<char*>(&header));
+    int words_per_slot = (num_objects + 63) / 64;
+    size_t arrays_size = header.num_matrix_words * sizeof(uint64_t) +
+                         (header.num_slot_begin + 2 * header.num_cells + header.num_day_literals +
+                          header.num_types) * sizeof(int32_t);
+    if (not std::equal(MODEL_CACHE_MAGIC, MODEL_CACHE_MAGIC + sizeof(MODEL_CACHE_MAGIC), header.magic) or
+        (header.version != MODEL_CACHE_VERSION) or (header.key != key) or
+        (header.num_matrix_words != size_t(num_total_slots) * words_per_slot) or
+        (header.num_types != size_t(num_objects)) or
+        (file->size != sizeof(header) + arrays_size + header.model_size) or
+        (header.model_size > size_t(std::numeric_limits<int>::max()))) {
+        std::cerr << "Model cache file " << filename << " is damaged, the model is rebuilt" << std::endl;
+        return false;
+    }
+    const char* data = file->data + sizeof(header);
+    uint64_t* matrix_words = reinterpret_cast<uint64_t*>(file->data + sizeof(header));
+    data += header.num_matrix_words * sizeof(uint64_t);
+    range.first_day = header.first_day;
+    range.last_day = header.last_day;
+    read_cache_array(data, header.num_slot_begin, range.slot_begin);
+    read_cache_array(data, header.num_cells, range.cell_object);
+    read_cache_array(data, header.num_cells, range.cell_literal);
+    read_cache_array(data, header.num_day_literals, range.day_literal);
+    std::vector<int> stored_types;
+    read_cache_array(data, header.num_types, stored_types);
+    objects_type.assign(stored_types.begin(), stored_types.end());
+    if (not model_proto.ParseFromArray(data, int(header.model_size))) {
+        std::cerr << "Model cache file " << filename << " is damaged, the model is rebuilt" << std::endl;
+        return false;
+    }
+    availability_matrix.num_slots = num_total_slots;
+    availability_matrix.num_objects = num_objects;
+    availability_matrix.words_per_slot = words_per_slot;
+    availability_matrix.storage.clear();
+    availability_matrix.words = matrix_words;
+    availability_matrix.mapping = std::move(file);
+    return true;
+}
 
-    // Solving part
-    const CpSolverResponse response = Solve(cp_model.Build());
+// Solves the whole horizon model, then writes, validates and reports the schedule
+bool
+solve_whole_model(const CpModelProto& model_proto,
+                  const DayRangeModel& range,
+                  const AvailabilityMatrix& availability_matrix,
+                  const std::vector<bool>& objects_type)
+{
+    const SatParameters parameters = make_solver_parameters();
+    LOG(INFO) << "Solver: " << parameters.num_workers() << " workers"
+              << (parameters.interleave_search() ? ", deterministic" : "")
+              << (time_limit_seconds > 0
+                    ? (parameters.interleave_search() ? ", deterministic time limit " : ", time limit ") +
+                        std::to_string(time_limit_seconds) + " s"
+                    : "");
+    pipeline_stats.start_phase();
+    Model solver_model;
+    solver_model.Add(NewSatParameters(parameters));
+    int num_streamed_solutions = 0;
+    if (stream_solutions or best_effort) {
+        // Every schedule found replaces the previous one in the output file,
+        // best-effort solves report the objective and bound as they improve
+        solver_model.Add(NewFeasibleSolutionObserver([&](const CpSolverResponse& partial_response) {
+            if (best_effort) {
+                pipeline_stats.progress.push_back({partial_response.wall_time(),
+                                                   partial_response.objective_value(),
+                                                   partial_response.best_objective_bound()});
+                LOG(INFO) << "Objective " << partial_response.objective_value() << ", bound "
+                          << partial_response.best_objective_bound() << " at "
+                          << partial_response.wall_time() << " s";
+            }
+            if (not stream_solutions) {
+                return;
+            }
+            Schedule partial_solution = extract_schedule(partial_response, range, num_days);
+            if (save_schedule_to_file(output_filename, partial_solution)) {
+                num_streamed_solutions++;
+                LOG(INFO) << "Solution " << num_streamed_solutions << " written to " << output_filename
+                          << " at " << partial_response.wall_time() << " s";
+            }
+        }));
+    }
+    const CpSolverResponse response = SolveCpModel(model_proto, &solver_model);
+    pipeline_stats.end_phase("solve");
+    LOG(INFO) << "Solve time: " << response.wall_time() << " s";
 
     if (response.status() == CpSolverStatus::OPTIMAL or
         response.status() == CpSolverStatus::FEASIBLE) {
-        for (int slot_index = 0; slot_index < num_total_slots; slot_index++) {
-            if (slot_index % num_daily_slots == 0) {
-                std::cout << "Day " << slot_index / num_daily_slots << std::endl;
+        Schedule solution = extract_schedule(response, range, num_days);
+        if (print_grid) {
+            print_schedule_grid(solution);
+        }
+        if (not output_filename.empty()) {
+            save_schedule_to_file(output_filename, solution);
+        }
+        pipeline_stats.end_phase("output");
+        if (response.status() == CpSolverStatus::FEASIBLE) {
+            LOG(INFO) << "Search stopped by limit, best found schedule is printed.";
+        }
+        if (best_effort) {
+            LOG(INFO) << count_scheduled_objects(solution, objects_type) << " of " << num_objects
+                      << " objects are scheduled, objective " << response.objective_value()
+                      << ", bound " << response.best_objective_bound();
+        }
+        LOG(INFO) << validate_solution(solution, availability_matrix, objects_type, best_effort);
+        pipeline_stats.end_phase("validate");
+    } else if (response.status() == CpSolverStatus::UNKNOWN) {
+        LOG(INFO) << "No solution found before the search limit.";
+    } else {
+        LOG(INFO) << "No solution found.";
+    }
+
+    // Statistics.
+    LOG(INFO) << "Statistics";
+    LOG(INFO) << CpSolverResponseStats(response);
+    report_pipeline_stats(CpSolverStatus_Name(response.status()));
+    return true;
+}
+
+// Everything after loading: presolve, the engines and the output. The matrix is changed by
+// the blacked out slots and by presolve
+bool
+schedule_loaded_objects(AvailabilityMatrix& availability_matrix,
+                        const std::vector<bool>& objects_type,
+                        bool cache_key_ready,
+                        uint64_t cache_key)
+{
+    apply_blackouts(availability_matrix);
+
+    PresolveResult presolve_result;
+    PresolveResult monolithic_presolve;
+    if (use_presolve) {
+        presolve(availability_matrix, objects_type, presolve_result);
+        pipeline_stats.end_phase("presolve");
+        if (not presolve_result.unschedulable_objects.empty()) {
+            for (int object_index : presolve_result.unschedulable_objects) {
+                LOG(INFO) << "Object " << object_index << " can't be viewed in "
+                          << object_days_requirement(objects_type, object_index)
+                          << " days with " << object_daily_views_requirement(objects_type, object_index)
+                          << " views in a window of " << daily_slots_window_size << " slots"
+                          << (objects_type[object_index] or not has_geometric_progression()
+                                ? "" : " following the geometric progression");
             }
-            for (int object_index = 0; object_index < num_objects; object_index++) {
-                if (SolutionBooleanValue(response,
-                                         schedule[slot_index * num_objects + object_index])) {
-                    std::cout << "# ";
-                } else {
-                    std::cout << ". ";
+            if (best_effort or (rolling_window_days > 0)) {
+                // Partial schedules leave them out, the monolithic comparison solves with all of them
+                if (compare_monolithic and (rolling_window_days > 0)) {
+                    monolithic_presolve = presolve_result;
+                }
+                for (int object_index : presolve_result.unschedulable_objects) {
+                    for (int day_index = 0; day_index < num_days; day_index++) {
+                        presolve_result.is_day_usable[day_index * num_objects + object_index] = 0;
+                    }
+                }
+                LOG(INFO) << presolve_result.unschedulable_objects.size()
+                          << " objects can't be scheduled and are skipped.";
+            } else {
+                LOG(INFO) << presolve_result.unschedulable_objects.size()
+                          << " objects can't be scheduled, the model is infeasible.";
+                LOG(INFO) << "No solution found.";
+                if (diagnose_mode and not core_filename.empty()) {
+                    // Each of them is a core by itself
+                    std::ofstream file(core_filename, std::ios::trunc);
+                    file << "# " << presolve_result.unschedulable_objects.size()
+                         << " objects can't be scheduled by themselves\n";
+                    for (int object_index : presolve_result.unschedulable_objects) {
+                        file << "object," << object_index << "\n";
+                    }
                 }
+                report_pipeline_stats("PRESOLVE_INFEASIBLE");
+                return false;
+            }
+        }
+    } else {
+        presolve_result.is_day_usable.assign(num_days * num_objects, 1);
+    }
+
+    // Partial schedules and the diagnosis don't need every object to fit
+    if (use_precheck and not best_effort and (rolling_window_days == 0) and not diagnose_mode) {
+        bool is_precheck_passed = precheck_feasibility(availability_matrix, objects_type,
+                                                       presolve_result.is_day_usable);
+        pipeline_stats.end_phase("precheck");
+        if (not is_precheck_passed) {
+            LOG(INFO) << "No solution found.";
+            report_pipeline_stats("PRECHECK_INFEASIBLE");
+            return false;
+        }
+    }
+
+    if (rolling_window_days > 0) {
+        auto rolling_start = std::chrono::steady_clock::now();
+        Schedule solution;
+        generate_rolling_schedule(availability_matrix, objects_type, presolve_result, solution);
+        std::chrono::duration<double> rolling_time = std::chrono::steady_clock::now() - rolling_start;
+        if (print_grid) {
+            print_schedule_grid(solution);
+        }
+        if (not output_filename.empty()) {
+            save_schedule_to_file(output_filename, solution);
+        }
+        pipeline_stats.end_phase("output");
+        int num_scheduled_objects = count_scheduled_objects(solution, objects_type);
+        LOG(INFO) << num_scheduled_objects << " of " << num_objects << " objects are scheduled.";
+        LOG(INFO) << validate_solution(solution, availability_matrix, objects_type, true);
+        pipeline_stats.end_phase("validate");
+        if (compare_monolithic) {
+            compare_with_monolithic(availability_matrix, objects_type,
+                                    monolithic_presolve.is_day_usable.empty() ? presolve_result
+                                                                              : monolithic_presolve,
+                                    num_scheduled_objects, rolling_time.count());
+        }
+        report_pipeline_stats(num_scheduled_objects == num_objects ? "FEASIBLE" : "PARTIAL");
+        return true;
+    }
+
+    if (diagnose_mode) {
+        return diagnose_infeasibility(availability_matrix, objects_type, presolve_result);
+    }
+
+    // Best-effort mode maximizes the weight of fully scheduled objects
+    bool use_weights = best_effort;
+    std::vector<int64_t> object_weights(num_objects, 1);
+    if (best_effort and not weights_filename.empty()) {
+        if (not load_object_weights(weights_filename, object_weights)) {
+            return false;
+        }
+    }
+
+    // Previous schedule as a warm start
+    AvailabilityMatrix hinted_cells;
+    std::vector<uint8_t> is_object_fixed(num_objects, 0);
+    bool use_hint = not hint_filename.empty();
+    if (use_hint) {
+        if (not prepare_hint(availability_matrix, objects_type, hinted_cells, is_object_fixed)) {
+            return false;
+        }
+        pipeline_stats.end_phase("load_hint");
+    }
+
+    // Greedy schedule, either the answer or the hint of the solver
+    if ((engine == HEURISTIC_ENGINE) or ((engine == HYBRID_ENGINE) and not use_hint)) {
+        Schedule heuristic_solution;
+        int num_heuristic_objects = generate_heuristic_schedule(availability_matrix, objects_type,
+                                                                object_weights, heuristic_solution);
+        double heuristic_seconds = pipeline_stats.end_phase("heuristic").seconds;
+        LOG(INFO) << "Heuristic scheduled " << num_heuristic_objects << " of " << num_objects
+                  << " objects in " << heuristic_seconds << " s";
+        if (engine == HYBRID_ENGINE) {
+            hinted_cells.resize(num_total_slots, num_objects);
+            for (const std::pair<int, int>& view : heuristic_solution.views) {
+                hinted_cells.set_available(view.first, view.second);
+            }
+            use_hint = true;
+        } else if ((num_heuristic_objects == num_objects) or best_effort) {
+            if (print_grid) {
+                print_schedule_grid(heuristic_solution);
+            }
+            if (not output_filename.empty()) {
+                save_schedule_to_file(output_filename, heuristic_solution);
+            }
+            pipeline_stats.end_phase("output");
+            LOG(INFO) << validate_solution(heuristic_solution, availability_matrix, objects_type, best_effort);
+            pipeline_stats.end_phase("validate");
+            report_pipeline_stats(num_heuristic_objects == num_objects ? "FEASIBLE" : "PARTIAL");
+            return true;
+        } else {
+            LOG(INFO) << "The heuristic found no complete schedule, try --engine " << HYBRID_ENGINE;
+            report_pipeline_stats("UNKNOWN");
+            return false;
+        }
+    }
+
+    // Interchangeable objects
+    std::vector<std::vector<int>> identical_objects;
+    if (use_symmetry_breaking) {
+        identical_objects = find_identical_objects(availability_matrix, objects_type, object_weights,
+                                                   is_object_fixed);
+        pipeline_stats.end_phase("symmetry");
+        int num_grouped_objects = 0;
+        for (const std::vector<int>& group : identical_objects) {
+            num_grouped_objects += group.size();
+            std::ostringstream group_objects;
+            for (int object_index : group) {
+                group_objects << (object_index == group[0] ? "" : ", ") << object_index;
+            }
+            LOG(INFO) << "Identical objects: " << group_objects.str();
+        }
+        LOG(INFO) << identical_objects.size() << " groups of identical objects, "
+                  << num_grouped_objects << " objects";
+        if (use_hint) {
+            order_identical_hint(hinted_cells, identical_objects);
+        }
+    }
+
+    // Independent groups of objects are solved as separate models
+    ObjectComponents components;
+    if (use_decomposition) {
+        find_object_components(availability_matrix, presolve_result.is_day_usable, components);
+        pipeline_stats.end_phase("components");
+        LOG(INFO) << "Found " << components.objects.size() << " independent components of objects";
+    }
+    if (components.objects.size() > 1) {
+        if (cache_key_ready) {
+            LOG(INFO) << "Models of independent components aren't cached";
+        }
+        Schedule solution;
+        CpSolverStatus status;
+        bool is_solved = solve_components(availability_matrix, objects_type, presolve_result,
+                                          use_hint ? &hinted_cells : nullptr, is_object_fixed,
+                                          identical_objects, use_weights ? &object_weights : nullptr,
+                                          components, solution, status);
+        pipeline_stats.end_phase("solve");
+        if (is_solved) {
+            if (print_grid) {
+                print_schedule_grid(solution);
             }
-            std::cout << std::endl;
+            if (not output_filename.empty()) {
+                save_schedule_to_file(output_filename, solution);
+            }
+            pipeline_stats.end_phase("output");
+            if (best_effort) {
+                LOG(INFO) << count_scheduled_objects(solution, objects_type) << " of " << num_objects
+                          << " objects are scheduled.";
+            }
+            LOG(INFO) << validate_solution(solution, availability_matrix, objects_type, best_effort);
+            pipeline_stats.end_phase("validate");
+        } else if (status == CpSolverStatus::UNKNOWN) {
+            LOG(INFO) << "No solution found before the search limit.";
+        } else {
+            LOG(INFO) << "No solution found.";
+        }
+        report_pipeline_stats(CpSolverStatus_Name(status));
+        return true;
+    }
+
+    ProtoModelBuilder model;
+    DayRangeModel range;
+    build_monolithic_model(model, availability_matrix, objects_type,
+                           use_hint ? &hinted_cells : nullptr, is_object_fixed, nullptr,
+                           use_weights ? &object_weights : nullptr, nullptr, &pipeline_stats,
+                           build_threads, presolve_result, range);
+    add_symmetry_breaking(model, range, identical_objects, nullptr);
+    pipeline_stats.end_model_phase("symmetry_breaking", model.proto);
+
+    const CpModelProto& model_proto = model.proto;
+    pipeline_stats.end_phase("build");
+    pipeline_stats.model_variables = model_proto.variables_size();
+    pipeline_stats.model_constraints = model_proto.constraints_size();
+    pipeline_stats.model_terms = count_model_terms(model_proto);
+    LOG(INFO) << "Window encoding: " << window_encoding
+              << ", progression encoding: " << progression_encoding;
+    LOG(INFO) << "Model size: " << pipeline_stats.model_variables << " variables, "
+              << pipeline_stats.model_constraints << " constraints, "
+              << pipeline_stats.model_terms << " terms";
+    LOG(INFO) << "Build time: " << pipeline_stats.build_seconds() << " s";
+    if (use_presolve) {
+        LOG(INFO) << "Presolve removed " << presolve_result.removed_day_variables << " of "
+                  << num_days * num_objects << " day variables, "
+                  << presolve_result.removed_cells << " cell variables, "
+                  << presolve_result.removed_constraints << " constraints";
+    }
+
+    if (cache_key_ready) {
+        if (save_model_cache(cache_key, model_proto, range, availability_matrix, objects_type)) {
+            LOG(INFO) << "Model saved to the cache as " << model_cache_filename(cache_key);
+        }
+        pipeline_stats.end_phase("save_cache");
+    }
+
+    return solve_whole_model(model_proto, range, availability_matrix, objects_type);
+}
+
+bool
+generate_schedule()
+{
+    // A cached model of the same inputs skips loading and building
+    uint64_t cache_key = 0;
+    bool cache_key_ready = false;
+    if (not model_cache_directory.empty() and (rolling_window_days == 0) and not diagnose_mode and
+        (engine != HEURISTIC_ENGINE)) {
+        pipeline_stats.start_phase();
+        cache_key_ready = model_cache_key(cache_key);
+        CpModelProto cached_model;
+        DayRangeModel cached_range;
+        AvailabilityMatrix cached_matrix;
+        std::vector<bool> cached_types;
+        if (cache_key_ready and
+            load_model_cache(cache_key, cached_model, cached_range, cached_matrix, cached_types)) {
+            pipeline_stats.end_phase("load_cache");
+            pipeline_stats.model_variables = cached_model.variables_size();
+            pipeline_stats.model_constraints = cached_model.constraints_size();
+            pipeline_stats.model_terms = count_model_terms(cached_model);
+            LOG(INFO) << "Model loaded from the cache " << model_cache_filename(cache_key) << ": "
+                      << pipeline_stats.model_variables << " variables, "
+                      << pipeline_stats.model_constraints << " constraints";
+            return solve_whole_model(cached_model, cached_range, cached_matrix, cached_types);
         }
-        LOG(INFO) << validate_solution(response, schedule, availability_matrix, objects_type);
-    } else {
-        LOG(INFO) << "No solution found.";
+        pipeline_stats.end_phase("cache_key");
     }
 
-    // Statistics.
-    LOG(INFO) << "Statistics";
-    LOG(INFO) << CpSolverResponseStats(response);
+    // Load data from files
+    pipeline_stats.start_phase();
+    AvailabilityMatrix availability_matrix;
+    if (not load_matrix_from_file(availability_matrix_filename, availability_matrix)) {
+        return false;
+    }
+    pipeline_stats.end_phase("load_matrix");
+    std::vector<bool> objects_type(num_objects);
+    load_vector_from_file(objects_type_filename, objects_type);
+    pipeline_stats.end_phase("load_types");
+
+    return schedule_loaded_objects(availability_matrix, objects_type, cache_key_ready, cache_key);
 }
 
 } // namespace sat
 } // namespace operations_research
 
+// Parses the flags argv[i], argv[i + 1], ... into the configuration, 0 on success
 int
-main(int argc, char* argv[])
+parse_arguments(int argc, char* argv[], int i)
 {
-    int i = 1;
     while (i < argc){
         try {
             std::string cur_key(argv[i]);
@@ -533,6 +4100,241 @@ main(int argc, char* argv[])
                     return 1;
                 }
                 progression_ratio = std::stoi(argv[i]);  
+            } else if ((cur_key == WINDOW_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                daily_slots_window_size = std::stoi(argv[i]);
+            } else if ((cur_key == WINDOW_ENCODING_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                window_encoding = argv[i];
+                if ((window_encoding != PAIRWISE_WINDOW_ENCODING) and
+                    (window_encoding != LINEAR_WINDOW_ENCODING)) {
+                    std::cerr << "Unknown window encoding '" << window_encoding << "', use "
+                              << PAIRWISE_WINDOW_ENCODING << " or " << LINEAR_WINDOW_ENCODING
+                              << std::endl;
+                    return 1;
+                }
+            } else if ((cur_key == PROGRESSION_ENCODING_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                progression_encoding = argv[i];
+                if ((progression_encoding != PREFIX_PROGRESSION_ENCODING) and
+                    (progression_encoding != START_PROGRESSION_ENCODING)) {
+                    std::cerr << "Unknown progression encoding '" << progression_encoding << "', use "
+                              << PREFIX_PROGRESSION_ENCODING << " or " << START_PROGRESSION_ENCODING
+                              << std::endl;
+                    return 1;
+                }
+            } else if ((cur_key == OUTPUT_FORMAT_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                output_format = argv[i];
+                if ((output_format != SPARSE_OUTPUT_FORMAT) and (output_format != BINARY_OUTPUT_FORMAT)) {
+                    std::cerr << "Unknown output format '" << output_format << "', use "
+                              << SPARSE_OUTPUT_FORMAT << " or " << BINARY_OUTPUT_FORMAT << std::endl;
+                    return 1;
+                }
+            } else if ((cur_key == STREAM_KEY)) {
+                stream_solutions = true;
+            } else if ((cur_key == GRID_KEY)) {
+                print_grid = true;
+            } else if ((cur_key == BEST_EFFORT_KEY)) {
+                best_effort = true;
+            } else if ((cur_key == WEIGHTS_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                weights_filename = argv[i];
+            } else if ((cur_key == DIAGNOSE_KEY)) {
+                diagnose_mode = true;
+            } else if ((cur_key == DIAGNOSE_DAYS_KEY)) {
+                diagnose_mode = true;
+                diagnose_days = true;
+            } else if ((cur_key == CORE_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                core_filename = argv[i];
+            } else if ((cur_key == ENGINE_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                engine = argv[i];
+                if ((engine != CP_SAT_ENGINE) and (engine != HEURISTIC_ENGINE) and
+                    (engine != HYBRID_ENGINE)) {
+                    std::cerr << "Unknown engine '" << engine << "', use " << CP_SAT_ENGINE << ", "
+                              << HEURISTIC_ENGINE << " or " << HYBRID_ENGINE << std::endl;
+                    return 1;
+                }
+            } else if ((cur_key == HEURISTIC_ROUNDS_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                heuristic_repair_rounds = std::stoi(argv[i]);
+            } else if ((cur_key == MODEL_CACHE_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                model_cache_directory = argv[i];
+            } else if ((cur_key == FIRST_DAY_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                first_allowed_day = std::stoi(argv[i]);
+            } else if ((cur_key == LAST_DAY_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                last_allowed_day = std::stoi(argv[i]);
+            } else if ((cur_key == BLOCK_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                // SLOT or FIRST-LAST
+                std::string slot_range(argv[i]);
+                size_t dash = slot_range.find('-', 1);
+                int first_slot = std::stoi(slot_range.substr(0, dash));
+                int last_slot = dash == std::string::npos ? first_slot : std::stoi(slot_range.substr(dash + 1));
+                blocked_slots.push_back(std::make_pair(first_slot, last_slot));
+            } else if ((cur_key == SOCKET_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                socket_path = argv[i];
+            } else if ((cur_key == SERVE_WORKERS_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                serve_workers = std::max(1, std::stoi(argv[i]));
+            } else if ((cur_key == SERVE_DIR_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                serve_directory = argv[i];
+            } else if ((cur_key == SERVE_QUIT_KEY)) {
+                serve_quit = true;
+            } else if ((cur_key == OUTPUT_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                output_filename = argv[i];
+            } else if ((cur_key == NO_PRESOLVE_KEY)) {
+                use_presolve = false;
+            } else if ((cur_key == NO_PRECHECK_KEY)) {
+                use_precheck = false;
+            } else if ((cur_key == STATS_JSON_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                stats_json_filename = argv[i];
+            } else if ((cur_key == SCHEDULE_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                schedule_filename = argv[i];
+            } else if ((cur_key == HINT_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                hint_filename = argv[i];
+            } else if ((cur_key == HINT_MODE_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                hint_mode = argv[i];
+                if ((hint_mode != HINT_MODE) and (hint_mode != REPAIR_HINT_MODE) and
+                    (hint_mode != FIX_HINT_MODE)) {
+                    std::cerr << "Unknown hint mode '" << hint_mode << "', use " << HINT_MODE
+                              << ", " << REPAIR_HINT_MODE << " or " << FIX_HINT_MODE << std::endl;
+                    return 1;
+                }
+            } else if ((cur_key == ROLLING_WINDOW_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                rolling_window_days = std::stoi(argv[i]);
+            } else if ((cur_key == ROLLING_OVERLAP_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                rolling_overlap_days = std::stoi(argv[i]);
+            } else if ((cur_key == COMPARE_MONOLITHIC_KEY)) {
+                compare_monolithic = true;
+            } else if ((cur_key == BUILD_THREADS_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                build_threads = std::max(1, std::stoi(argv[i]));
+            } else if ((cur_key == NO_DECOMPOSITION_KEY)) {
+                use_decomposition = false;
+            } else if ((cur_key == COMPONENT_THREADS_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                component_threads = std::max(1, std::stoi(argv[i]));
+            } else if ((cur_key == NO_SYMMETRY_BREAKING_KEY)) {
+                use_symmetry_breaking = false;
+            } else if ((cur_key == WORKERS_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                num_workers = std::stoi(argv[i]);
+            } else if ((cur_key == TIME_LIMIT_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                time_limit_seconds = std::stod(argv[i]);
+            } else if ((cur_key == SEED_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                random_seed = std::stoi(argv[i]);
+            } else if ((cur_key == DETERMINISTIC_KEY)) {
+                deterministic_search = true;
+            } else if ((cur_key == SAT_PARAMS_KEY)) {
+                if (++i >= argc) {
+                    std::cerr << "Flag " << argv[i-1] << " used without argument" << std::endl;
+                    return 1;
+                }
+                sat_parameters_text = argv[i];
+                operations_research::sat::SatParameters parsed_parameters;
+                if (not google::protobuf::TextFormat::ParseFromString(sat_parameters_text,
+                                                                      &parsed_parameters)) {
+                    std::cerr << "Can't parse SatParameters: " << sat_parameters_text << std::endl;
+                    return 1;
+                }
             } else {
                 std::cerr << "Unknown option '" << argv[i] << "'" << std::endl;
                 std::cerr << "Use " << DAYS_KEY << " (" << DAYS_SHORT_KEY << "), "
@@ -542,12 +4344,29 @@ main(int argc, char* argv[])
                                     << A_DAYS_KEY << ", " << B_DAYS_KEY << ", "
                                     << RATIO_KEY << " (" << RATIO_SHORT_KEY <<"), "
                                     << MATRIX_KEY << " (" << MATRIX_SHORT_KEY <<"), "
-                                    << TYPES_KEY << " (" << TYPES_SHORT_KEY <<")"
+                                    << TYPES_KEY << " (" << TYPES_SHORT_KEY <<"), "
+                                    << WINDOW_KEY << ", " << WINDOW_ENCODING_KEY << ", "
+                                    << PROGRESSION_ENCODING_KEY << ", " << OUTPUT_FORMAT_KEY << ", "
+                                    << STREAM_KEY << ", " << GRID_KEY << ", " << BEST_EFFORT_KEY << ", "
+                                    << WEIGHTS_KEY << ", " << DIAGNOSE_KEY << ", " << DIAGNOSE_DAYS_KEY << ", "
+                                    << CORE_KEY << ", " << ENGINE_KEY << ", " << HEURISTIC_ROUNDS_KEY << ", "
+                                    << MODEL_CACHE_KEY << ", " << FIRST_DAY_KEY << ", " << LAST_DAY_KEY << ", "
+                                    << BLOCK_KEY << ", " << SOCKET_KEY << ", " << SERVE_WORKERS_KEY << ", "
+                                    << SERVE_DIR_KEY << ", " << SERVE_QUIT_KEY << ", "
+                                    << WORKERS_KEY << ", " << TIME_LIMIT_KEY << ", "
+                                    << SEED_KEY << ", " << DETERMINISTIC_KEY << ", "
+                                    << SAT_PARAMS_KEY << ", " << OUTPUT_KEY << ", "
+                                    << NO_PRESOLVE_KEY << ", " << NO_PRECHECK_KEY << ", " << STATS_JSON_KEY << ", "
+                                    << SCHEDULE_KEY << ", " << HINT_KEY << ", " << HINT_MODE_KEY << ", "
+                                    << ROLLING_WINDOW_KEY << ", " << ROLLING_OVERLAP_KEY << ", "
+                                    << COMPARE_MONOLITHIC_KEY << ", " << BUILD_THREADS_KEY << ", "
+                                    << NO_DECOMPOSITION_KEY << ", " << COMPONENT_THREADS_KEY << ", "
+                                    << NO_SYMMETRY_BREAKING_KEY
                                     << std::endl;
                 return 1;
             }
         } catch (const std::invalid_argument& e) {
-            std::cerr << "Invalid argument, after flag: " << argv[i-1] << " expected integer, but found: " << argv[i] << std::endl;
+            std::cerr << "Invalid argument, after flag: " << argv[i-1] << " expected number, but found: " << argv[i] << std::endl;
             return 1;
         } catch (const std::out_of_range& e) {
             std::cerr << "Argument out of range: " << argv[i] << std::endl;
@@ -556,6 +4375,399 @@ main(int argc, char* argv[])
         i++;
     }
     num_total_slots = num_days * num_daily_slots;
-    operations_research::sat::generate_schedule();
+    if ((rolling_window_days > 0) and
+        ((rolling_overlap_days < 0) or (rolling_overlap_days >= rolling_window_days))) {
+        std::cerr << ROLLING_OVERLAP_KEY << " has to be in [0, " << ROLLING_WINDOW_KEY << ")" << std::endl;
+        return 1;
+    }
+    if (stream_solutions and output_filename.empty()) {
+        std::cerr << STREAM_KEY << " needs " << OUTPUT_KEY << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// A connection of serve mode: requests are lines read from input_fd, responses go to output_fd
+struct ServeClient
+{
+    int input_fd = -1;
+    int output_fd = -1;
+    std::string buffer;
+    bool is_reading = true;
+    int queued_requests = 0;
+};
+
+struct ServeRequest
+{
+    int request_id;
+    int client_id;
+    std::string line;
+};
+
+bool
+write_all(int fd, const std::string& text)
+{
+    size_t written = 0;
+    while (written < text.size()) {
+        ssize_t result = write(fd, text.data() + written, text.size() - written);
+        if ((result < 0) and (errno == EINTR)) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        written += result;
+    }
+    return true;
+}
+
+// Runs in the forked worker: the request flags are parsed over the server configuration,
+// the schedule is written to output_fd as
+// "result ID STATUS VIEWS", VIEWS "slot,object" lines and "end ID".
+// Blackouts and presolve change availability_matrix in place. That is safe only because the
+// worker has its own copy-on-write copy of the server matrix, it must never run in the server
+void
+handle_request(const ServeRequest& request,
+               int output_fd,
+               AvailabilityMatrix& availability_matrix,
+               const std::vector<bool>& objects_type)
+{
+    using operations_research::sat::pipeline_stats;
+
+    int server_days = num_days;
+    int server_slots = num_daily_slots;
+    int server_objects = num_objects;
+    std::string server_matrix = availability_matrix_filename;
+    std::string server_types = objects_type_filename;
+
+    std::vector<std::string> tokens(1, SERVE_COMMAND);
+    std::istringstream line(request.line);
+    std::string token;
+    while (line >> token) {
+        tokens.push_back(token);
+    }
+    std::vector<char*> arguments;
+    for (std::string& argument : tokens) {
+        arguments.push_back(&argument[0]);
+    }
+    arguments.push_back(nullptr);
+
+    std::string status = "ERROR";
+    Schedule solution;
+    std::string request_output = serve_directory + "/request_" + std::to_string(request.request_id) + ".txt";
+    std::string previous_solution;
+    if (parse_arguments(int(tokens.size()), arguments.data(), 1) != 0) {
+        std::cerr << "Request " << request.request_id << " is malformed: " << request.line << std::endl;
+    } else if ((num_days != server_days) or (num_daily_slots != server_slots) or
+               (num_objects != server_objects) or (availability_matrix_filename != server_matrix) or
+               (objects_type_filename != server_types)) {
+        std::cerr << "Request " << request.request_id << " can't change " << DAYS_KEY << ", " << SLOTS_KEY
+                  << ", " << OBJECTS_KEY << ", " << MATRIX_KEY << " and " << TYPES_KEY << std::endl;
+    } else {
+        // The schedule goes to the response only, the previous answer is the hint
+        output_filename = request_output;
+        output_format = SPARSE_OUTPUT_FORMAT;
+        stream_solutions = false;
+        print_grid = false;
+        model_cache_directory.clear();
+        // Only a request over the same days hints the next one
+        int last_day = last_allowed_day < 0 ? num_days - 1 : last_allowed_day;
+        previous_solution = serve_directory + "/previous_" + std::to_string(first_allowed_day) + "_" +
+                            std::to_string(last_day) + ".txt";
+        if (hint_filename.empty() and (access(previous_solution.c_str(), R_OK) == 0)) {
+            hint_filename = previous_solution;
+        }
+        pipeline_stats = operations_research::sat::PipelineStats();
+        operations_research::sat::schedule_loaded_objects(availability_matrix, objects_type, false, 0);
+        status = pipeline_stats.status.empty() ? status : pipeline_stats.status;
+        if ((access(request_output.c_str(), R_OK) == 0) and
+            not load_schedule_from_file(request_output, solution)) {
+            status = "ERROR";
+        }
+    }
+
+    std::string response = "result " + std::to_string(request.request_id) + " " + status + " " +
+                           std::to_string(solution.views.size()) + "\n";
+    for (const std::pair<int, int>& view : solution.views) {
+        response += std::to_string(view.first) + "," + std::to_string(view.second) + "\n";
+    }
+    response += "end " + std::to_string(request.request_id) + "\n";
+
+    // Workers share the output of standard input requests, a response is written whole
+    int lock_fd = open((serve_directory + "/output.lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (lock_fd >= 0) {
+        flock(lock_fd, LOCK_EX);
+    }
+    write_all(output_fd, response);
+    if (lock_fd >= 0) {
+        close(lock_fd);
+    }
+
+    if (not solution.views.empty() and (access(request_output.c_str(), R_OK) == 0)) {
+        std::rename(request_output.c_str(), previous_solution.c_str());
+    } else {
+        unlink(request_output.c_str());
+    }
+}
+
+// serve mode: keeps the matrix and the object types in memory and answers requests, one line
+// of flags each (--first_day, --last_day, --block, requirements, solver limits, ...), on standard
+// input or on the connections of a Unix socket. Every request is solved in a forked worker
+// process, at most serve_workers at once, since the configuration is global.
+// The schedule of the latest solved request over the same days is the hint of the next ones
+bool
+serve_requests()
+{
+    using operations_research::sat::pipeline_stats;
+
+    AvailabilityMatrix availability_matrix;
+    if (not load_matrix_from_file(availability_matrix_filename, availability_matrix)) {
+        return false;
+    }
+    std::vector<bool> objects_type(num_objects);
+    load_vector_from_file(objects_type_filename, objects_type);
+    pipeline_stats.end_phase("load");
+    LOG(INFO) << "Loaded " << num_objects << " objects in " << pipeline_stats.phases.back().seconds << " s";
+
+    if (serve_directory.empty()) {
+        char directory_template[] = "/tmp/satellite_schedule.XXXXXX";
+        if (mkdtemp(directory_template) == nullptr) {
+            std::cerr << "Can't create a directory for the requests" << std::endl;
+            return false;
+        }
+        serve_directory = directory_template;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    // A worker exit writes a byte to the pipe the wait for requests polls, so it blocks
+    // until a request or an exit arrives, even when the worker exits just before the wait
+    static int child_exit_pipe[2] = {-1, -1};
+    if (pipe(child_exit_pipe) != 0) {
+        std::cerr << "Can't create a pipe for the worker exits" << std::endl;
+        return false;
+    }
+    for (int fd : child_exit_pipe) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    signal(SIGCHLD, [](int) {
+        int saved_errno = errno;
+        ssize_t written = write(child_exit_pipe[1], "", 1);
+        (void)written;
+        errno = saved_errno;
+    });
+
+    std::map<int, ServeClient> clients;
+    int next_client_id = 0;
+    int listen_fd = -1;
+    if (socket_path.empty()) {
+        ServeClient& client = clients[next_client_id++];
+        client.input_fd = STDIN_FILENO;
+        client.output_fd = STDOUT_FILENO;
+    } else {
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if ((listen_fd < 0) or (socket_path.size() >= sizeof(address.sun_path))) {
+            std::cerr << "Can't create socket " << socket_path << std::endl;
+            return false;
+        }
+        std::copy(socket_path.begin(), socket_path.end(), address.sun_path);
+        unlink(socket_path.c_str());
+        if ((bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) or
+            (listen(listen_fd, 64) != 0)) {
+            std::cerr << "Can't listen on socket " << socket_path << std::endl;
+            close(listen_fd);
+            return false;
+        }
+    }
+    LOG(INFO) << "Serving on " << (socket_path.empty() ? "standard input" : socket_path) << " with "
+              << serve_workers << " workers, requests in " << serve_directory;
+
+    std::vector<ServeRequest> queue;
+    size_t queue_begin = 0;
+    std::map<pid_t, std::pair<int, std::chrono::steady_clock::time_point>> workers;
+    int next_request_id = 0;
+    bool is_stopping = false;
+    while (true) {
+        // Finished workers
+        int worker_status;
+        pid_t worker_pid;
+        while ((worker_pid = waitpid(-1, &worker_status, WNOHANG)) > 0) {
+            auto worker = workers.find(worker_pid);
+            if (worker != workers.end()) {
+                std::chrono::duration<double> duration = std::chrono::steady_clock::now() - worker->second.second;
+                LOG(INFO) << "Request " << worker->second.first << " answered in " << duration.count() << " s";
+                workers.erase(worker);
+            }
+        }
+
+        while ((queue_begin < queue.size()) and (int(workers.size()) < serve_workers)) {
+            const ServeRequest& request = queue[queue_begin++];
+            ServeClient& client = clients[request.client_id];
+            client.queued_requests--;
+            pid_t pid = fork();
+            if (pid == 0) {
+                signal(SIGCHLD, SIG_DFL);
+                close(child_exit_pipe[0]);
+                close(child_exit_pipe[1]);
+                if (listen_fd >= 0) {
+                    close(listen_fd);
+                }
+                for (const std::pair<const int, ServeClient>& other_client : clients) {
+                    if ((other_client.first != request.client_id) and
+                        (other_client.second.input_fd != STDIN_FILENO)) {
+                        close(other_client.second.input_fd);
+                    }
+                }
+                handle_request(request, client.output_fd, availability_matrix, objects_type);
+                _exit(EXIT_SUCCESS);
+            }
+            if (pid < 0) {
+                std::cerr << "Can't start a worker for request " << request.request_id << std::endl;
+                continue;
+            }
+            workers[pid] = std::make_pair(request.request_id, std::chrono::steady_clock::now());
+        }
+        if (queue_begin == queue.size()) {
+            queue.clear();
+            queue_begin = 0;
+        }
+
+        // Clients that sent everything and have nothing queued
+        for (auto client = clients.begin(); client != clients.end();) {
+            if (not client->second.is_reading and (client->second.queued_requests == 0)) {
+                if (client->second.input_fd != STDIN_FILENO) {
+                    close(client->second.input_fd);
+                }
+                client = clients.erase(client);
+            } else {
+                ++client;
+            }
+        }
+        if ((is_stopping or ((listen_fd < 0) and clients.empty())) and queue.empty() and workers.empty()) {
+            break;
+        }
+
+        // Client of every polled fd, -2 for the worker exit pipe and -1 for the listening socket
+        std::vector<pollfd> poll_fds;
+        std::vector<int> poll_clients;
+        poll_fds.push_back({child_exit_pipe[0], POLLIN, 0});
+        poll_clients.push_back(-2);
+        if ((listen_fd >= 0) and not is_stopping) {
+            poll_fds.push_back({listen_fd, POLLIN, 0});
+            poll_clients.push_back(-1);
+        }
+        for (const std::pair<const int, ServeClient>& client : clients) {
+            if (client.second.is_reading) {
+                poll_fds.push_back({client.second.input_fd, POLLIN, 0});
+                poll_clients.push_back(client.first);
+            }
+        }
+        // Workers are reaped at the start of the loop
+        if (poll(poll_fds.data(), poll_fds.size(), -1) <= 0) {
+            continue;
+        }
+        for (size_t poll_index = 0; poll_index < poll_fds.size(); poll_index++) {
+            if (poll_fds[poll_index].revents == 0) {
+                continue;
+            }
+            if (poll_clients[poll_index] == -2) {
+                char exits[64];
+                while (read(child_exit_pipe[0], exits, sizeof(exits)) > 0) {
+                }
+                continue;
+            }
+            if (poll_clients[poll_index] < 0) {
+                int connection_fd = accept(listen_fd, nullptr, nullptr);
+                if (connection_fd >= 0) {
+                    ServeClient& client = clients[next_client_id++];
+                    client.input_fd = connection_fd;
+                    client.output_fd = connection_fd;
+                }
+                continue;
+            }
+            ServeClient& client = clients[poll_clients[poll_index]];
+            char data[4096];
+            ssize_t size = read(client.input_fd, data, sizeof(data));
+            if (size <= 0) {
+                client.is_reading = false;
+                continue;
+            }
+            client.buffer.append(data, size);
+            size_t line_end;
+            while ((line_end = client.buffer.find('\n')) != std::string::npos) {
+                std::string line = client.buffer.substr(0, line_end);
+                client.buffer.erase(0, line_end + 1);
+                if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                    continue;
+                }
+                if (line.substr(0, line.find_last_not_of(" \t\r") + 1) == "quit") {
+                    if ((client.input_fd != STDIN_FILENO) and not serve_quit) {
+                        std::cerr << "quit from a socket client is ignored without " << SERVE_QUIT_KEY
+                                  << std::endl;
+                        continue;
+                    }
+                    is_stopping = true;
+                    for (std::pair<const int, ServeClient>& other_client : clients) {
+                        other_client.second.is_reading = false;
+                    }
+                    break;
+                }
+                LOG(INFO) << "Request " << next_request_id << ": " << line;
+                queue.push_back({next_request_id++, poll_clients[poll_index], line});
+                client.queued_requests++;
+            }
+        }
+    }
+    signal(SIGCHLD, SIG_DFL);
+    close(child_exit_pipe[0]);
+    close(child_exit_pipe[1]);
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        unlink(socket_path.c_str());
+    }
+    return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+    int i = 1;
+    bool convert_mode = false;
+    bool validate_mode = false;
+    bool serve_mode = false;
+    if ((argc > 1) and (argv[1] == CONVERT_COMMAND)) {
+        convert_mode = true;
+        i++;
+    } else if ((argc > 1) and (argv[1] == VALIDATE_COMMAND)) {
+        validate_mode = true;
+        i++;
+    } else if ((argc > 1) and (argv[1] == SERVE_COMMAND)) {
+        serve_mode = true;
+        i++;
+    }
+    if (parse_arguments(argc, argv, i) != 0) {
+        return 1;
+    }
+    if (convert_mode) {
+        if (output_filename.empty()) {
+            std::cerr << CONVERT_COMMAND << " needs " << OUTPUT_KEY << " file" << std::endl;
+            return 1;
+        }
+        return convert_matrix() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (validate_mode) {
+        if (schedule_filename.empty()) {
+            std::cerr << VALIDATE_COMMAND << " needs " << SCHEDULE_KEY << " file" << std::endl;
+            return 1;
+        }
+        return validate_schedule_file() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (serve_mode) {
+        return serve_requests() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (not operations_research::sat::generate_schedule()) {
+        return EXIT_FAILURE;
+    }
     return EXIT_SUCCESS;
 }